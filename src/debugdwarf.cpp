@@ -0,0 +1,506 @@
+/**
+  Purpose: Reader of DWARF line tables (.debug_line v2..v5) - resolve code address to file:line
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+#include "debugdwarf.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tsv::debuglog::dwarf
+{
+
+namespace
+{
+
+// Line number opcodes
+constexpr std::uint8_t kLnsCopy = 1;
+constexpr std::uint8_t kLnsAdvancePc = 2;
+constexpr std::uint8_t kLnsAdvanceLine = 3;
+constexpr std::uint8_t kLnsSetFile = 4;
+constexpr std::uint8_t kLnsConstAddPc = 8;
+constexpr std::uint8_t kLnsFixedAdvancePc = 9;
+constexpr std::uint8_t kLneEndSequence = 1;
+constexpr std::uint8_t kLneSetAddress = 2;
+
+// Entry formats of the v5 header
+constexpr std::uint64_t kLnctPath = 1;
+constexpr std::uint64_t kLnctDirectoryIndex = 2;
+constexpr std::uint64_t kFormBlock = 0x09;
+constexpr std::uint64_t kFormData1 = 0x0b;
+constexpr std::uint64_t kFormData2 = 0x05;
+constexpr std::uint64_t kFormData4 = 0x06;
+constexpr std::uint64_t kFormData8 = 0x07;
+constexpr std::uint64_t kFormData16 = 0x1e;
+constexpr std::uint64_t kFormString = 0x08;
+constexpr std::uint64_t kFormStrp = 0x0e;
+constexpr std::uint64_t kFormUdata = 0x0f;
+constexpr std::uint64_t kFormLineStrp = 0x1f;
+
+constexpr std::uint32_t kEndOfSequence = ~std::uint32_t{0};
+
+// Bounds-checked reader of the section. On overrun it stops at the end and remembers the failure.
+class Reader
+{
+public:
+    Reader(std::string_view data, std::size_t offset = 0)
+        : begin_(data.data()), pos_(data.data() + std::min(offset, data.size())), end_(data.data() + data.size())
+    {}
+
+    bool ok() const
+    {
+        return !failed_;
+    }
+
+    bool atEnd() const
+    {
+        return pos_ >= end_;
+    }
+
+    std::size_t offset() const
+    {
+        return static_cast<std::size_t>(pos_ - begin_);
+    }
+
+    template <typename T>
+    T fixed()
+    {
+        T value{};
+        if (!has(sizeof(T)))
+            return value;
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    // Unsigned value of the given size (offsets, addresses)
+    std::uint64_t sized(std::size_t size)
+    {
+        switch (size)
+        {
+        case 1: return fixed<std::uint8_t>();
+        case 2: return fixed<std::uint16_t>();
+        case 4: return fixed<std::uint32_t>();
+        case 8: return fixed<std::uint64_t>();
+        default: skip(size); return 0;
+        }
+    }
+
+    std::uint64_t uleb()
+    {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0;; shift += 7)
+        {
+            if (!has(1))
+                return value;
+            auto byte = static_cast<std::uint8_t>(*pos_++);
+            if (shift < 64)
+                value |= std::uint64_t{byte & 0x7fu} << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+    }
+
+    std::int64_t sleb()
+    {
+        std::uint64_t value = 0;
+        unsigned shift = 0;
+        std::uint8_t byte = 0;
+        do
+        {
+            if (!has(1))
+                return 0;
+            byte = static_cast<std::uint8_t>(*pos_++);
+            if (shift < 64)
+                value |= std::uint64_t{byte & 0x7fu} << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        if (shift < 64 && (byte & 0x40))
+            value |= ~std::uint64_t{0} << shift;
+        return static_cast<std::int64_t>(value);
+    }
+
+    std::string_view cstr()
+    {
+        auto* zero = pos_ < end_ ? static_cast<const char*>(std::memchr(pos_, 0, static_cast<std::size_t>(end_ - pos_)))
+                                 : nullptr;
+        if (!zero)
+        {
+            fail();
+            return {};
+        }
+        std::string_view rv(pos_, static_cast<std::size_t>(zero - pos_));
+        pos_ = zero + 1;
+        return rv;
+    }
+
+    void skip(std::uint64_t size)
+    {
+        if (has(size))
+            pos_ += size;
+    }
+
+    void seek(const char* pos)
+    {
+        if (pos > end_)
+            fail();
+        else
+            pos_ = pos;
+    }
+
+    const char* pos() const
+    {
+        return pos_;
+    }
+
+private:
+    bool has(std::uint64_t size)
+    {
+        if (size <= static_cast<std::uint64_t>(end_ - pos_))
+            return true;
+        fail();
+        return false;
+    }
+
+    void fail()
+    {
+        failed_ = true;
+        pos_ = end_;
+    }
+
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+    bool failed_ = false;
+};
+
+struct Header
+{
+    bool dwarf64 = false;
+    unsigned version = 0;
+    unsigned addressSize = sizeof(void*);
+    unsigned minInstLength = 1;
+    int lineBase = 0;
+    unsigned lineRange = 0;
+    unsigned opcodeBase = 0;
+    const char* opcodeLengths = nullptr;    // [opcodeBase - 1]
+    const char* tables = nullptr;           // directory and file tables
+    const char* program = nullptr;
+    const char* end = nullptr;              // end of the unit
+};
+
+// Parse the header of the unit at `offset`, set `next` to the offset of the next unit
+bool parseHeader(std::string_view section, std::size_t offset, Header& header, std::size_t& next)
+{
+    Reader reader(section, offset);
+    std::uint64_t length = reader.fixed<std::uint32_t>();
+    if (length == 0xffffffff)
+    {
+        header.dwarf64 = true;
+        length = reader.fixed<std::uint64_t>();
+    }
+    if (!reader.ok() || length > section.size() - reader.offset())
+        return false;
+    next = reader.offset() + length;
+    header.end = section.data() + next;
+
+    header.version = reader.fixed<std::uint16_t>();
+    if (header.version < 2 || header.version > 5)
+        return false;
+    if (header.version >= 5)
+    {
+        header.addressSize = reader.fixed<std::uint8_t>();
+        reader.fixed<std::uint8_t>();   // segment selector size
+    }
+    std::uint64_t headerLength = reader.sized(header.dwarf64 ? 8 : 4);
+    if (headerLength > static_cast<std::uint64_t>(header.end - reader.pos()))
+        return false;
+    header.program = reader.pos() + headerLength;
+
+    header.minInstLength = reader.fixed<std::uint8_t>();
+    if (header.version >= 4)
+        reader.fixed<std::uint8_t>();   // maximum operations per instruction (VLIW only)
+    reader.fixed<std::uint8_t>();       // default is_stmt
+    header.lineBase = reader.fixed<std::int8_t>();
+    header.lineRange = reader.fixed<std::uint8_t>();
+    header.opcodeBase = reader.fixed<std::uint8_t>();
+    header.opcodeLengths = reader.pos();
+    reader.skip(header.opcodeBase ? header.opcodeBase - 1 : 0);
+    header.tables = reader.pos();
+    return reader.ok() && header.lineRange != 0 && header.opcodeBase != 0 && reader.pos() <= header.program;
+}
+
+// Value of the v5 entry field
+bool readForm(Reader& reader, std::uint64_t form, const Header& header, const Sections& sections,
+              std::string_view& str, std::uint64_t& num)
+{
+    auto stringAt = [](std::string_view section, std::uint64_t offset) {
+        if (offset >= section.size())
+            return std::string_view{};
+        return std::string_view(section.data() + offset);
+    };
+    switch (form)
+    {
+    case kFormString: str = reader.cstr(); break;
+    case kFormLineStrp: str = stringAt(sections.lineStr, reader.sized(header.dwarf64 ? 8 : 4)); break;
+    case kFormStrp: str = stringAt(sections.str, reader.sized(header.dwarf64 ? 8 : 4)); break;
+    case kFormUdata: num = reader.uleb(); break;
+    case kFormData1: num = reader.sized(1); break;
+    case kFormData2: num = reader.sized(2); break;
+    case kFormData4: num = reader.sized(4); break;
+    case kFormData8: num = reader.sized(8); break;
+    case kFormData16: reader.skip(16); break;
+    case kFormBlock: reader.skip(reader.uleb()); break;
+    default: return false;     // string index forms need .debug_info - not supported
+    }
+    return reader.ok();
+}
+
+std::string joinPath(std::string_view dir, std::string_view name)
+{
+    if (dir.empty() || (!name.empty() && name[0] == '/'))
+        return std::string(name);
+    std::string rv(dir);
+    if (rv.back() != '/')
+        rv.push_back('/');
+    rv.append(name);
+    return rv;
+}
+
+// Full paths of the files in order of their indexes
+bool readFiles(const Header& header, const Sections& sections, std::vector<std::string>& files)
+{
+    Reader reader(std::string_view(header.tables, static_cast<std::size_t>(header.program - header.tables)));
+    std::vector<std::string> dirs;
+    if (header.version < 5)
+    {
+        // Directory #0 is the compilation directory which is known only from .debug_info
+        dirs.emplace_back();
+        for (auto dir = reader.cstr(); reader.ok() && !dir.empty(); dir = reader.cstr())
+            dirs.emplace_back(dir);
+        // File indexes start from 1
+        files.emplace_back();
+        for (auto name = reader.cstr(); reader.ok() && !name.empty(); name = reader.cstr())
+        {
+            auto dir = reader.uleb();
+            reader.uleb();  // modification time
+            reader.uleb();  // size
+            files.push_back(joinPath(dir < dirs.size() ? std::string_view(dirs[dir]) : std::string_view{}, name));
+        }
+        return reader.ok();
+    }
+
+    // Read table of entries described by the list of (content type, form)
+    auto readEntries = [&](auto&& onEntry) {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> formats(reader.fixed<std::uint8_t>());
+        for (auto& format : formats)
+            format = {reader.uleb(), reader.uleb()};
+        auto count = reader.uleb();
+        for (std::uint64_t i = 0; i < count && reader.ok(); i++)
+        {
+            std::string_view path;
+            std::uint64_t dirIndex = 0;
+            for (const auto& [type, form] : formats)
+            {
+                std::string_view str;
+                std::uint64_t num = 0;
+                if (!readForm(reader, form, header, sections, str, num))
+                    return false;
+                if (type == kLnctPath)
+                    path = str;
+                else if (type == kLnctDirectoryIndex)
+                    dirIndex = num;
+            }
+            onEntry(path, dirIndex);
+        }
+        return reader.ok();
+    };
+
+    // Directory #0 is the compilation directory, others could be relative to it
+    bool ok = readEntries([&](std::string_view path, std::uint64_t) {
+        dirs.push_back(dirs.empty() ? std::string(path) : joinPath(dirs[0], path));
+    });
+    return ok && readEntries([&](std::string_view path, std::uint64_t dirIndex) {
+        files.push_back(joinPath(dirIndex < dirs.size() ? std::string_view(dirs[dirIndex]) : std::string_view{}, path));
+    });
+}
+
+// Run the line number program, call emit(address, file, line, endSequence) for each row
+template <typename Fn>
+bool runProgram(const Header& header, Fn&& emit)
+{
+    Reader reader(std::string_view(header.program, static_cast<std::size_t>(header.end - header.program)));
+    std::uint64_t address = 0;
+    std::uint64_t file = 1;
+    std::int64_t line = 1;
+    auto advance = [&](std::uint64_t operations) { address += operations * header.minInstLength; };
+
+    while (!reader.atEnd())
+    {
+        auto opcode = reader.fixed<std::uint8_t>();
+        if (opcode >= header.opcodeBase)
+        {
+            unsigned adjusted = opcode - header.opcodeBase;
+            advance(adjusted / header.lineRange);
+            line += header.lineBase + static_cast<int>(adjusted % header.lineRange);
+            emit(address, file, line, false);
+        }
+        else if (opcode == 0)
+        {
+            auto length = reader.uleb();
+            if (length == 0 || length > static_cast<std::uint64_t>(header.end - reader.pos()))
+                continue;
+            const char* next = reader.pos() + length;
+            auto extended = reader.fixed<std::uint8_t>();
+            if (extended == kLneEndSequence)
+            {
+                emit(address, file, line, true);
+                address = 0;
+                file = 1;
+                line = 1;
+            }
+            else if (extended == kLneSetAddress)
+            {
+                address = reader.sized(static_cast<std::size_t>(length - 1));
+            }
+            reader.seek(next);
+        }
+        else if (opcode == kLnsCopy)
+            emit(address, file, line, false);
+        else if (opcode == kLnsAdvancePc)
+            advance(reader.uleb());
+        else if (opcode == kLnsAdvanceLine)
+            line += reader.sleb();
+        else if (opcode == kLnsSetFile)
+            file = reader.uleb();
+        else if (opcode == kLnsConstAddPc)
+            advance((255 - header.opcodeBase) / header.lineRange);
+        else if (opcode == kLnsFixedAdvancePc)
+            address += reader.fixed<std::uint16_t>();
+        else
+        {
+            // Skip operands of other standard opcodes (column, flags, isa)
+            for (int i = 0; i < header.opcodeLengths[opcode - 1]; i++)
+                reader.uleb();
+        }
+        if (!reader.ok())
+            return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+struct LineTable::Rows
+{
+    struct Row
+    {
+        std::uintptr_t address;
+        std::uint32_t file;     // kEndOfSequence for the end of sequence
+        std::uint32_t line;
+    };
+
+    std::vector<std::string> files;
+    std::vector<Row> rows;      // sorted by address
+};
+
+LineTable::LineTable(const Sections& sections)
+    : sections_(sections)
+{
+    std::vector<std::size_t> offsets;
+    std::size_t next = 0;
+    for (std::size_t offset = 0; offset < sections_.line.size(); offset = next)
+    {
+        Header header;
+        if (!parseHeader(sections_.line, offset, header, next))
+            break;
+        auto unit = static_cast<std::uint32_t>(offsets.size());
+        offsets.push_back(offset);
+
+        // Only the ranges of sequences are remembered here
+        bool inSequence = false;
+        std::uintptr_t low = 0;
+        runProgram(header, [&](std::uint64_t address, std::uint64_t, std::int64_t, bool endSequence) {
+            if (!inSequence)
+            {
+                low = static_cast<std::uintptr_t>(address);
+                inSequence = true;
+            }
+            if (endSequence)
+            {
+                // Sequences of the functions dropped by the linker start from 0
+                if (low && address > low)
+                    ranges_.push_back({low, static_cast<std::uintptr_t>(address), unit});
+                inSequence = false;
+            }
+        });
+    }
+
+    units_ = std::make_unique<Unit[]>(offsets.size());
+    for (std::size_t i = 0; i < offsets.size(); i++)
+        units_[i].offset = offsets[i];
+    std::sort(ranges_.begin(), ranges_.end(), [](const Range& a, const Range& b) { return a.low < b.low; });
+}
+
+LineTable::~LineTable()
+{
+    if (!units_)
+        return;
+    for (const auto& range : ranges_)
+        delete units_[range.unit].rows.exchange(nullptr);
+}
+
+const LineTable::Rows* LineTable::getRows(Unit& unit)
+{
+    if (const auto* rows = unit.rows.load(std::memory_order_acquire))
+        return rows;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const auto* rows = unit.rows.load(std::memory_order_relaxed))
+        return rows;
+
+    auto rows = std::make_unique<Rows>();
+    Header header;
+    std::size_t next = 0;
+    if (parseHeader(sections_.line, unit.offset, header, next))
+    {
+        readFiles(header, sections_, rows->files);
+        runProgram(header, [&](std::uint64_t address, std::uint64_t file, std::int64_t line, bool endSequence) {
+            rows->rows.push_back({static_cast<std::uintptr_t>(address),
+                                  endSequence ? kEndOfSequence : static_cast<std::uint32_t>(file),
+                                  static_cast<std::uint32_t>(line)});
+        });
+    }
+    // End of the sequence goes before the start of the next one at the same address
+    std::stable_sort(rows->rows.begin(), rows->rows.end(), [](const Rows::Row& a, const Rows::Row& b) {
+        return a.address < b.address
+               || (a.address == b.address && a.file == kEndOfSequence && b.file != kEndOfSequence);
+    });
+    unit.rows.store(rows.get(), std::memory_order_release);
+    return rows.release();
+}
+
+bool LineTable::find(std::uintptr_t addr, std::string_view& file, int& line)
+{
+    auto range = std::upper_bound(ranges_.begin(), ranges_.end(), addr,
+                                  [](std::uintptr_t value, const Range& r) { return value < r.low; });
+    if (range == ranges_.begin() || addr >= (--range)->high)
+        return false;
+
+    const auto* rows = getRows(units_[range->unit]);
+    auto row = std::upper_bound(rows->rows.begin(), rows->rows.end(), addr,
+                                [](std::uintptr_t value, const Rows::Row& r) { return value < r.address; });
+    if (row == rows->rows.begin())
+        return false;
+    --row;
+    if (row->file == kEndOfSequence || row->file >= rows->files.size() || row->line == 0)
+        return false;
+    file = rows->files[row->file];
+    line = static_cast<int>(row->line);
+    return true;
+}
+
+}  // namespace tsv::debuglog::dwarf
@@ -0,0 +1,457 @@
+/**
+  Purpose: Asynchronous output of the logger lines
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+#include "debuglog_async.h"
+
+#include "tostr_fmt_include.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tsv::debuglog::async
+{
+
+namespace
+{
+
+// Lines shorter than this are copied into the record without allocation
+constexpr std::size_t kReservedLineSize = 256;
+
+// Lines logged from the output handler are written synchronously to avoid self-deadlock
+thread_local bool isWriterThread_t = false;
+
+struct Record
+{
+    std::atomic<std::size_t> seq;
+    OutputHandler handler;
+    RenderFn render;      // nullptr if the line is ready
+    sentry_enum::Level level;
+    sentry_enum::Kind kind;
+    std::string line;     // ready line or payload to render. capacity is kept between uses
+};
+
+/**
+ * Bounded MPMC queue (D.Vyukov's algorithm).
+ * Each thread has its own queue, so usually there is single producer and single consumer (writer thread).
+ * But with Overflow::DropOldest the producer also pops records, so the both sides should be safe.
+ */
+class RingBuffer
+{
+public:
+    RingBuffer(std::size_t size, Overflow overflowPolicy)
+        : overflow(overflowPolicy)
+    {
+        std::size_t capacity = 2;
+        while (capacity < size)
+            capacity <<= 1;
+        mask_ = capacity - 1;
+        buffer_ = std::make_unique<Record[]>(capacity);
+        for (std::size_t i = 0; i < capacity; i++)
+        {
+            buffer_[i].seq.store(i, std::memory_order_relaxed);
+            buffer_[i].line.reserve(kReservedLineSize);
+        }
+    }
+
+    // fill(std::string&) puts the content of the record
+    template <typename Fn>
+    bool tryPush(OutputHandler handler, sentry_enum::Level level, sentry_enum::Kind kind, RenderFn render, Fn&& fill)
+    {
+        Record* cell;
+        std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &buffer_[pos & mask_];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;  // full
+            else
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+        cell->handler = handler;
+        cell->render = render;
+        cell->level = level;
+        cell->kind = kind;
+        cell->line.clear();
+        fill(cell->line);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Fn>
+    bool tryPop(Fn&& fn)
+    {
+        Record* cell;
+        std::size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &buffer_[pos & mask_];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;  // empty
+            else
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+        }
+        fn(*cell);
+        if (cell->line.capacity() > kReservedLineSize * 4)
+            cell->line = std::string();  // do not keep too huge lines forever
+        if (cell->line.capacity() < kReservedLineSize)
+            cell->line.reserve(kReservedLineSize);
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Overflow::Block: wait until the consumer frees a slot (or `timeout` passes).
+    // Return false if the record still doesn't fit.
+    template <typename Fn>
+    bool pushOrWait(OutputHandler handler,
+                    sentry_enum::Level level,
+                    sentry_enum::Kind kind,
+                    RenderFn render,
+                    Fn&& fill,
+                    std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lk(spaceMutex_);
+        waiting_.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in notifySpace(): either the consumer sees waiting_, or we see the freed slot
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool pushed = tryPush(handler, level, kind, render, fill);
+        if (!pushed)
+            spaceCv_.wait_for(lk, timeout);
+        waiting_.store(false, std::memory_order_relaxed);
+        return pushed;
+    }
+
+    // Called by the consumer after it takes the record
+    void notifySpace()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lk(spaceMutex_);
+            spaceCv_.notify_all();
+        }
+    }
+
+    const Overflow overflow;            // policy of the writer generation which created the queue
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<OutputHandler> lastHandler{nullptr};
+    std::atomic<bool> orphaned{false};  // owner thread is finished
+
+private:
+    std::unique_ptr<Record[]> buffer_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> enqueuePos_{0};
+    alignas(64) std::atomic<std::size_t> dequeuePos_{0};
+
+    // Producer blocked by the full buffer sleeps here
+    std::mutex spaceMutex_;
+    std::condition_variable spaceCv_;
+    std::atomic<bool> waiting_{false};
+};
+
+class Writer
+{
+public:
+    ~Writer() { stop(); }
+
+    bool start(const Args& args)
+    {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        if (active_.load(std::memory_order_relaxed))
+            return false;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            args_ = args;
+            if (args_.bufferSize == 0)
+                args_.bufferSize = 1;
+            if (args_.flushIntervalMs <= 0)
+                args_.flushIntervalMs = 1;
+            stop_ = false;
+            queues_.clear();
+            generation_.fetch_add(1, std::memory_order_relaxed);
+        }
+        thread_ = std::thread([this] { run(); });
+        active_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        if (!active_.exchange(false))
+            return;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    void flush()
+    {
+        if (!active_.load(std::memory_order_acquire) || isWriterThread_t)
+            return;
+        std::unique_lock<std::mutex> lk(mutex_);
+        auto ticket = ++flushRequested_;
+        cv_.notify_one();
+        flushedCv_.wait(lk, [&] { return flushDone_ >= ticket || stop_; });
+    }
+
+    bool isActive() const { return active_.load(std::memory_order_relaxed); }
+
+    template <typename Fn>
+    bool push(OutputHandler handler, sentry_enum::Level level, sentry_enum::Kind kind, RenderFn render, Fn&& fill);
+
+private:
+    struct Producer
+    {
+        ~Producer()
+        {
+            if (queue)
+                queue->orphaned.store(true, std::memory_order_release);
+        }
+        std::shared_ptr<RingBuffer> queue;
+        std::uint64_t generation = 0;
+    };
+
+    RingBuffer& getQueue();
+    void wakeUp()
+    {
+        if (sleeping_.load(std::memory_order_relaxed))
+            cv_.notify_one();
+    }
+    void run();
+    static void drain(RingBuffer& queue);
+
+    std::mutex controlMutex_;  // serialize start()/stop()
+    std::atomic<bool> active_{false};
+    std::atomic<bool> sleeping_{false};
+    std::atomic<std::uint64_t> generation_{0};
+
+    std::mutex mutex_;  // guards members below
+    std::condition_variable cv_;
+    std::condition_variable flushedCv_;
+    std::vector<std::shared_ptr<RingBuffer>> queues_;
+    Args args_;
+    bool stop_ = false;
+    std::uint64_t flushRequested_ = 0;
+    std::uint64_t flushDone_ = 0;
+    std::thread thread_;
+};
+
+Writer& getWriter()
+{
+    // Destructor of this static drains buffers at exit
+    static Writer writer;
+    return writer;
+}
+
+RingBuffer& Writer::getQueue()
+{
+    thread_local Producer producer_t;
+    auto generation = generation_.load(std::memory_order_relaxed);
+    if (!producer_t.queue || producer_t.generation != generation)
+    {
+        // Args are read under the lock because start() could change them right now.
+        // The queue keeps its own copy, so the producer never reads args_ afterwards.
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto queue = std::make_shared<RingBuffer>(args_.bufferSize, args_.overflow);
+        queues_.push_back(queue);
+        producer_t.queue = std::move(queue);
+        producer_t.generation = generation_.load(std::memory_order_relaxed);
+    }
+    return *producer_t.queue;
+}
+
+template <typename Fn>
+bool Writer::push(OutputHandler handler, sentry_enum::Level level, sentry_enum::Kind kind, RenderFn render, Fn&& fill)
+{
+    if (!active_.load(std::memory_order_acquire) || isWriterThread_t)
+        return false;
+
+    RingBuffer& queue = getQueue();
+    queue.lastHandler.store(handler, std::memory_order_relaxed);
+    while (!queue.tryPush(handler, level, kind, render, fill))
+    {
+        switch (queue.overflow)
+        {
+            case Overflow::DropNewest:
+                queue.dropped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            case Overflow::DropOldest:
+                queue.dropped.fetch_add(1, std::memory_order_relaxed);
+                // Could fail only if the writer is taking the last record right now
+                if (!queue.tryPop([](Record&) {}))
+                    return true;
+                break;
+            case Overflow::Block:
+                if (!active_.load(std::memory_order_acquire))
+                    return false;
+                cv_.notify_one();
+                // Timeout only rechecks that the writer is still active
+                if (queue.pushOrWait(handler, level, kind, render, fill, std::chrono::milliseconds(10)))
+                {
+                    wakeUp();
+                    return true;
+                }
+                break;
+        }
+    }
+    wakeUp();
+    return true;
+}
+
+void Writer::drain(RingBuffer& queue)
+{
+    // Take the record out of the slot before calling the handler, so a slow handler
+    // doesn't hold the slot and the producer is able to reuse it.
+    // Swap keeps capacity of the both strings, so no allocation here.
+    thread_local std::string line_t;
+    thread_local std::string rendered_t;
+    OutputHandler handler;
+    RenderFn render;
+    sentry_enum::Level level;
+    sentry_enum::Kind kind;
+    while (queue.tryPop([&](Record& r) {
+        handler = r.handler;
+        render = r.render;
+        level = r.level;
+        kind = r.kind;
+        line_t.swap(r.line);
+    }))
+    {
+        queue.notifySpace();
+        if (render)
+        {
+            rendered_t.clear();
+            render(line_t, rendered_t);
+            handler(level, kind, rendered_t);
+        }
+        else
+            handler(level, kind, line_t);
+    }
+
+    auto dropped = queue.dropped.exchange(0, std::memory_order_relaxed);
+    handler = queue.lastHandler.load(std::memory_order_relaxed);
+    if (dropped && handler)
+        handler(sentry_enum::Level::Warning,
+                sentry_enum::Kind::Default,
+                TOSTR_FMT("[debuglog] {} records dropped", dropped));
+}
+
+void Writer::run()
+{
+    isWriterThread_t = true;
+    std::vector<std::shared_ptr<RingBuffer>> queues;
+    std::vector<const RingBuffer*> orphans;
+
+    std::unique_lock<std::mutex> lk(mutex_);
+    for (;;)
+    {
+        auto ticket = flushRequested_;
+        bool stopping = stop_;
+        queues = queues_;
+        lk.unlock();
+
+        orphans.clear();
+        for (auto& queue : queues)
+        {
+            // Check the flag before draining, so the last records of the finished thread are not lost
+            if (queue->orphaned.load(std::memory_order_acquire))
+                orphans.push_back(queue.get());
+            drain(*queue);
+        }
+
+        lk.lock();
+        // Forget queues of finished threads. They are drained already and nobody could push there.
+        queues_.erase(std::remove_if(queues_.begin(),
+                                     queues_.end(),
+                                     [&](const auto& q) {
+                                         return std::find(orphans.begin(), orphans.end(), q.get()) != orphans.end();
+                                     }),
+                      queues_.end());
+        flushDone_ = ticket;
+        flushedCv_.notify_all();
+        if (stopping)
+            break;
+        if (flushRequested_ > flushDone_ || stop_)
+            continue;
+
+        sleeping_.store(true, std::memory_order_relaxed);
+        cv_.wait_for(lk, std::chrono::milliseconds(args_.flushIntervalMs));
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+    // Threads which are still alive will create new queue on next start()
+    queues_.clear();
+    flushDone_ = flushRequested_;
+    flushedCv_.notify_all();
+}
+
+}  // namespace
+
+bool start(Args args)
+{
+    return getWriter().start(args);
+}
+
+void stop()
+{
+    getWriter().stop();
+}
+
+void flush()
+{
+    getWriter().flush();
+}
+
+bool isActive()
+{
+    return getWriter().isActive();
+}
+
+bool push(OutputHandler handler, sentry_enum::Level level, sentry_enum::Kind kind, std::string_view line)
+{
+    return getWriter().push(handler, level, kind, nullptr, [line](std::string& buf) {
+        buf.assign(line.data(), line.size());
+    });
+}
+
+bool push(OutputHandler handler,
+          sentry_enum::Level level,
+          sentry_enum::Kind kind,
+          RenderFn render,
+          FillFn fill,
+          const void* context)
+{
+    return getWriter().push(handler, level, kind, render, [fill, context](std::string& buf) {
+        fill(buf, context);
+    });
+}
+
+}  // namespace tsv::debuglog::async
@@ -0,0 +1,77 @@
+/**
+  Purpose: Process-wide table of interned strings
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+#include "debuglog_intern.h"
+#include "debuglog_singleton.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace tsv::debuglog
+{
+
+namespace
+{
+
+class StringTable
+{
+public:
+    static StringTable& get()
+    {
+        return impl::leakedSingleton<StringTable>();
+    }
+
+    const std::string& intern(std::string_view str)
+    {
+        struct Entry
+        {
+            const char* data = nullptr;
+            const std::string* str = nullptr;
+        };
+        thread_local Entry cache_t[kCacheSize]{};
+
+        auto value = reinterpret_cast<std::uintptr_t>(str.data());
+        auto& entry = cache_t[(value ^ (value >> 8)) % kCacheSize];
+        if (entry.data == str.data() && entry.str && *entry.str == str)
+            return *entry.str;
+
+        const std::string* rv;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(str);
+            if (it != index_.end())
+                rv = it->second;
+            else
+            {
+                // Elements of the deque are never moved, so the references and the keys stay valid
+                rv = &strings_.emplace_back(str);
+                index_.emplace(*rv, rv);
+            }
+        }
+        entry = {str.data(), rv};
+        return *rv;
+    }
+
+private:
+    static constexpr std::size_t kCacheSize = 256;
+
+    std::mutex mutex_;
+    std::deque<std::string> strings_;
+    // Keyed by the view, so the lookup doesn't allocate
+    std::unordered_map<std::string_view, const std::string*> index_;
+};
+
+}  // namespace
+
+const std::string& internString(std::string_view str)
+{
+    return StringTable::get().intern(str);
+}
+
+}  // namespace tsv::debuglog
@@ -9,11 +9,29 @@
 #define DEBUG_LOGGING 1
 
 #include "debuglog_settings.h"
+#include "debuglog_async.h"
+#include "debuglog_recorder.h"
+#include "debuglog_stats.h"
+#include "debuglog_trace.h"
+#include "debuglog_intern.h"
+#include "debuglog_singleton.h"
 #include "debugresolve.h"
 
 #include "tostr_fmt_include.h"
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
+#include <linux/membarrier.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace
 {
@@ -32,20 +50,13 @@ namespace tsv::debuglog
 /**
  *   STATIC VARIABLES + SETTINGS
  */
-bool Settings::stackTraceEnabled_s = true;
-bool Settings::isNestedLevelMode_s = true;   // if true, then show graphically hierarchy
-bool Settings::printContextFlag_s = true;
-bool Settings::printKindFlag_s = true;
-// do not change this initial value over Level::Off
-SentryLogger::Level Settings::logLevel_s = SentryLogger::Level::Info;
-// do not change this initial value over Level::Off
-SentryLogger::Level Settings::defaultSentryLoggerLevel_s = SentryLogger::Level::Info;
-SentryLogger::Level Settings::watchLogLevel_s  = SentryLogger::Level::Default;
-Settings::OutputHandler Settings::outputHandler_s = defaultLoggerHandler;
-std::string Settings::loggerPrefix_s = "";
-std::vector<std::string> Settings::cutoffNamespaces_s;
-
-int SentryLogger::currentLevel_s  = 0 ;
+// must match to initial values of Settings::Snapshot and empty kinds state
+SentryLogger::EnablementTable SentryLogger::enablement_s = {
+    0,
+    static_cast<std::uint8_t>(static_cast<SentryLogger::EnumType_t>(SentryLogger::Level::Info) + 1),
+    static_cast<std::uint8_t>(static_cast<SentryLogger::EnumType_t>(SentryLogger::Level::Info) + 1),
+    static_cast<std::uint8_t>(SentryLogger::Level::Info),
+    {}};
 
 /**
  * Local Helpers
@@ -53,20 +64,12 @@ int SentryLogger::currentLevel_s  = 0 ;
 namespace
 {
 
-//TODO: singletone to make sure it already initialized
-
-// Prefixes which are printed for each kind
-std::vector<std::string> kindNamesStr =
-{
-    ""  // Default - no special mark
-        //,"[Sample]"   // Sample correspondance kind to its output signature
-};
-
-bool isStageAllowed(SentryLogger::Flags flags, SentryLogger::Stage stage)
+// Print the flight recorder before the printed line if that is requested or the line is about an error
+void triggerRecorder(SentryLogger::Level level)
 {
-    // trick: stages match to corresponding Suppress flags
-    return !(static_cast<SentryLogger::EnumType_t>(flags)
-             & static_cast<SentryLogger::EnumType_t>(stage));
+    recorder::dumpIfRequested();
+    if (level <= SentryLogger::Level::Error && recorder::getArgs().dumpOnError)
+        recorder::dump();
 }
 
 bool startsWith(std::string_view base, std::string_view lookup )
@@ -80,6 +83,143 @@ inline bool isKindValid(sentry_enum::Kind kind)
             && static_cast<sentry_enum::EnumType_t>(kind) < getNumberOfKinds());
 }
 
+// Incremented when the names generated from __PRETTY_FUNCTION__ could change (cutoffNamespaces)
+std::atomic<unsigned> nameGeneration_s{0};
+
+/**
+ * Append-only table of context names. Names are interned (see "debuglog_intern.h"),
+ * so sentries keep only the string_view. Each kind of lookup is first done in the small
+ * per-thread direct-mapped cache, the global table is locked only on its miss.
+ */
+class ContextNames
+{
+public:
+    using MakeNameFn = std::string (*)(const char* prettyName);
+
+    static ContextNames& get()
+    {
+        return impl::leakedSingleton<ContextNames>();
+    }
+
+    // Name of the call site given by the string literal (__PRETTY_FUNCTION__ or "|file:line")
+    std::string_view resolve(const char* prettyName, MakeNameFn makeName)
+    {
+        struct Entry
+        {
+            const char* prettyName;
+            unsigned generation;
+            std::string_view name;
+        };
+        thread_local Entry cache_t[kCacheSize]{};
+
+        auto generation = nameGeneration_s.load(std::memory_order_relaxed);
+        auto& entry = cache_t[slot(prettyName)];
+        if (entry.prettyName == prettyName && entry.generation == generation)
+            return entry.name;
+
+        std::string_view name;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = bySite_.find(prettyName);
+            if (it != bySite_.end() && it->second.first == generation)
+                name = it->second.second;
+        }
+        if (name.data() == nullptr)
+        {
+            // Evaluate without lock, because it reads settings
+            name = intern(makeName(prettyName));
+            std::lock_guard<std::mutex> lock(mutex_);
+            bySite_[prettyName] = {generation, name};
+        }
+        entry = {prettyName, generation, name};
+        return name;
+    }
+
+    // Name given at runtime (could be not a literal, so the content is verified)
+    std::string_view intern(std::string_view name)
+    {
+        return internString(name);
+    }
+
+    // "parent--child" for Flags::AppendContextName. Both arguments are interned names or literals.
+    std::string_view join(std::string_view parent, std::string_view child)
+    {
+        struct Entry
+        {
+            const char* parent = nullptr;
+            const char* child = nullptr;
+            std::string_view name;
+        };
+        thread_local Entry cache_t[kCacheSize]{};
+
+        auto& entry = cache_t[slot(parent.data()) ^ slot(child.data())];
+        if (entry.parent == parent.data() && entry.child == child.data())
+            return entry.name;
+
+        std::string_view name;
+        auto key = std::make_pair(parent.data(), child.data());
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = joined_.find(key);
+            if (it != joined_.end())
+                name = it->second;
+        }
+        if (name.data() == nullptr)
+        {
+            std::string full{parent};
+            full.append("--").append(child);
+            name = intern(full);
+            std::lock_guard<std::mutex> lock(mutex_);
+            joined_.emplace(key, name);
+        }
+        entry = {parent.data(), child.data(), name};
+        return name;
+    }
+
+private:
+    static constexpr std::size_t kCacheSize = 256;
+
+    struct PairHash
+    {
+        std::size_t operator()(const std::pair<const char*, const char*>& key) const
+        {
+            return std::hash<const char*>()(key.first) * 31 + std::hash<const char*>()(key.second);
+        }
+    };
+
+    static std::size_t slot(const void* ptr)
+    {
+        auto value = reinterpret_cast<std::uintptr_t>(ptr);
+        return (value ^ (value >> 8)) % kCacheSize;
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<const char*, std::pair<unsigned, std::string_view>> bySite_;
+    std::unordered_map<std::pair<const char*, const char*>, std::string_view, PairHash> joined_;
+};
+
+// Identity of the thread for Settings::LineField::ThreadId/ThreadName
+struct ThreadTag
+{
+    int id;
+    std::string_view name;      // interned, so it is valid after the thread exit
+};
+
+thread_local ThreadTag threadTag_t{};
+
+const ThreadTag& getThreadTag()
+{
+    auto& tag = threadTag_t;
+    if (!tag.id)
+    {
+        char name[16] = {};
+        ::pthread_getname_np(::pthread_self(), name, sizeof(name));
+        tag.name = ContextNames::get().intern(name);
+        tag.id = static_cast<int>(::syscall(SYS_gettid));
+    }
+    return tag;
+}
+
 }   // namespace anonymous
 
 
@@ -98,140 +238,441 @@ sentry_enum::EnumType_t __attribute__((weak)) getNumberOfKinds()
 /**
     Settings
 */
-int* Settings::getKindsStateArray()
+/**
+ * Snapshot publishing.
+ * Readers announce the global epoch which they have seen before taking the pointer.
+ * Replaced snapshot is tagged with the epoch of its replacement and is deleted only
+ * when every active reader has announced later epoch.
+ * The store-load ordering between the announce and the pointer load is paid by the writer:
+ * membarrier(2) runs the full barrier on every thread of the process, so readers need only
+ * a compiler fence. If the kernel has no membarrier, readers fall back to own full fence.
+ */
+namespace
+{
+
+struct ReaderRecord
 {
-    // Default everything is turned off
-    static std::vector<int> kindsStateArray(
-        static_cast<std::vector<int>::size_type>(getNumberOfKinds() + 1));
-    LOCAL_DEBUG(std::string arr;
-                for (int i
-                     : kindsStateArray) arr += "." + std::to_string(i);
-                fmt::print("<{}>", arr);)
-    return kindsStateArray.data();
+    std::atomic<std::uint64_t> epoch{0};    // 0 = not inside of Reader
+    std::atomic<bool> inUse{false};         // record is owned by some thread
+    ReaderRecord* next = nullptr;
+    int depth = 0;                          // nesting of Readers. Accessed only by owner thread
+};
+
+// Push-only list of records. Records of finished threads are reused.
+std::atomic<ReaderRecord*> readerRecords_s{nullptr};
+std::atomic<std::uint64_t> globalEpoch_s{1};
+std::atomic<const Settings::Snapshot*> current_s{nullptr};
+
+thread_local ReaderRecord* readerRecord_t = nullptr;
+
+// Set once the process is registered for MEMBARRIER_CMD_PRIVATE_EXPEDITED
+std::atomic<bool> heavyBarrier_s{false};
+
+void initHeavyBarrier()
+{
+    static bool initialized_s = [] {
+        auto cmds = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+        if (cmds > 0 && (cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED)
+            && syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0)
+            heavyBarrier_s.store(true, std::memory_order_release);
+        return true;
+    }();
+    (void)initialized_s;
+}
+
+// Writer side of the asymmetric barrier
+void heavyBarrier()
+{
+    initHeavyBarrier();
+    if (!heavyBarrier_s.load(std::memory_order_acquire)
+        || syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0) != 0)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+// Reader side of the asymmetric barrier
+inline void lightBarrier()
+{
+    if (heavyBarrier_s.load(std::memory_order_relaxed))
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    else
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+struct ReaderRecordReleaser
+{
+    ~ReaderRecordReleaser()
+    {
+        if (readerRecord_t)
+            readerRecord_t->inUse.store(false, std::memory_order_release);
+        readerRecord_t = nullptr;
+    }
+};
+
+ReaderRecord* acquireReaderRecord()
+{
+    thread_local ReaderRecordReleaser releaser_t;
+    (void)releaser_t;
+    initHeavyBarrier();
+
+    ReaderRecord* rec = readerRecords_s.load(std::memory_order_acquire);
+    for (; rec; rec = rec->next)
+    {
+        bool expected = false;
+        if (!rec->inUse.load(std::memory_order_relaxed)
+            && rec->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            break;
+    }
+    if (!rec)
+    {
+        rec = new ReaderRecord;
+        rec->inUse.store(true, std::memory_order_relaxed);
+        rec->next = readerRecords_s.load(std::memory_order_relaxed);
+        while (!readerRecords_s.compare_exchange_weak(rec->next, rec, std::memory_order_release))
+        {
+        }
+    }
+    readerRecord_t = rec;
+    return rec;
 }
 
-bool Settings::isKindAllowed(SentryLogger::Kind kind)
+// Layout contains time or thread, so they should be kept for the lines which are formatted later
+std::atomic<bool> lineOriginUsed_s{false};
+
+// Translate the line layout to the list of steps for the current flags and prefix
+void compileLineLayout(Settings::Snapshot& snapshot)
+{
+    using LineField = Settings::LineField;
+    auto& ops = snapshot.lineOps;
+    ops.clear();
+    auto appendText = [&ops](std::string_view text) {
+        if (text.empty())
+            return;
+        if (!ops.empty() && ops.back().field == LineField::Prefix)
+            ops.back().text.append(text);
+        else
+            ops.push_back({LineField::Prefix, std::string(text)});
+    };
+
+    bool originUsed = false;
+    for (auto field : snapshot.lineLayout)
+    {
+        switch (field)
+        {
+            case LineField::Prefix:
+                appendText(snapshot.loggerPrefix);
+                break;
+            case LineField::Nested:
+                if (snapshot.isNestedLevelMode)
+                    ops.push_back({field, {}});
+                break;
+            case LineField::Kind:
+                if (snapshot.printKindFlag)
+                    ops.push_back({field, {}});
+                break;
+            case LineField::Context:
+                if (snapshot.printContextFlag)
+                    ops.push_back({field, {}});
+                else
+                    appendText("{}");
+                break;
+            case LineField::Timestamp:
+            case LineField::ThreadId:
+            case LineField::ThreadName:
+                originUsed = true;
+                ops.push_back({field, {}});
+                break;
+            default:
+                ops.push_back({field, {}});
+                break;
+        }
+    }
+    lineOriginUsed_s.store(originUsed, std::memory_order_relaxed);
+}
+
+const Settings::Snapshot* loadCurrent()
+{
+    const auto* snapshot = current_s.load(std::memory_order_acquire);
+    if (snapshot)
+        return snapshot;
+
+    // Lazy creation of the initial snapshot (getNumberOfKinds() is defined by the user)
+    auto* initial = new Settings::Snapshot;
+    initial->outputHandler = defaultLoggerHandler;
+    initial->kindsState.resize(static_cast<std::size_t>(getNumberOfKinds() + 1));
+    initial->kindNames = {""};  // Default - no special mark
+    compileLineLayout(*initial);
+    if (current_s.compare_exchange_strong(snapshot, initial, std::memory_order_acq_rel))
+        return initial;
+    delete initial;
+    return snapshot;
+}
+
+int kindState(const Settings::Snapshot& snapshot, SentryLogger::Kind kind)
+{
+    auto idx = static_cast<std::size_t>(kind);
+    return (idx < snapshot.kindsState.size()) ? snapshot.kindsState[idx] : 0;
+}
+
+bool kindAllowed(const Settings::Snapshot& snapshot, SentryLogger::Kind kind)
 {
     return (kind > SentryLogger::Kind::Off
-            && static_cast<EnumType_t>(kind) < getNumberOfKinds()
-            && !!getKindsStateArray()[static_cast<EnumType_t>(kind)]);
+            && static_cast<sentry_enum::EnumType_t>(kind) < getNumberOfKinds()
+            && !!kindState(snapshot, kind));
+}
+
+SentryLogger::Level kindStateAsLevel(const Settings::Snapshot& snapshot, SentryLogger::Kind kind)
+{
+    auto rv = static_cast<sentry_enum::EnumType_t>(kindState(snapshot, kind));
+    if (rv > static_cast<sentry_enum::EnumType_t>(SentryLogger::Level::Off))
+        rv = static_cast<sentry_enum::EnumType_t>(SentryLogger::Level::Off);
+    return static_cast<SentryLogger::Level>(rv);
+}
+
+class Publisher
+{
+public:
+    std::mutex mutex;   // serialize writers
+
+    void publishLocked(std::unique_ptr<Settings::Snapshot> next)
+    {
+        const auto* old = current_s.exchange(next.release(), std::memory_order_seq_cst);
+        auto epoch = globalEpoch_s.fetch_add(1, std::memory_order_seq_cst);
+        retired_.push_back({old, epoch});
+        reclaim();
+    }
+
+private:
+    struct Retired
+    {
+        const Settings::Snapshot* snapshot;
+        std::uint64_t epoch;
+    };
+
+    void reclaim()
+    {
+        heavyBarrier();
+        auto minEpoch = std::numeric_limits<std::uint64_t>::max();
+        for (auto* rec = readerRecords_s.load(std::memory_order_acquire); rec; rec = rec->next)
+        {
+            auto epoch = rec->epoch.load(std::memory_order_acquire);
+            if (epoch)
+                minEpoch = std::min(minEpoch, epoch);
+        }
+        auto reclaimed = std::partition(retired_.begin(), retired_.end(), [minEpoch](const Retired& r) {
+            return r.epoch >= minEpoch;
+        });
+        for (auto it = reclaimed; it != retired_.end(); ++it)
+            delete it->snapshot;
+        retired_.erase(reclaimed, retired_.end());
+    }
+
+    std::vector<Retired> retired_;
+};
+
+Publisher& getPublisher()
+{
+    return impl::leakedSingleton<Publisher>();
+}
+
+}   // namespace anonymous
+
+Settings::Reader::Reader()
+{
+    auto* rec = readerRecord_t ? readerRecord_t : acquireReaderRecord();
+    if (rec->depth++ == 0)
+    {
+        rec->epoch.store(globalEpoch_s.load(std::memory_order_acquire), std::memory_order_relaxed);
+        lightBarrier();
+    }
+    snapshot_ = loadCurrent();
+}
+
+Settings::Reader::~Reader()
+{
+    auto* rec = readerRecord_t;
+    if (rec && --rec->depth == 0)
+        rec->epoch.store(0, std::memory_order_release);
+}
+
+void Settings::refreshEnablementTable(const Snapshot& snapshot)
+{
+    auto& table = SentryLogger::enablement_s;
+    std::uint64_t kindMask = 0;
+    for (EnumType_t idx = 0; idx < SentryLogger::EnablementTable::kMaxKinds; idx++)
+    {
+        auto kind = static_cast<SentryLogger::Kind>(idx);
+        if (kindAllowed(snapshot, kind))
+            kindMask |= std::uint64_t{1} << idx;
+        table.kindLevel[idx].store(static_cast<std::uint8_t>(kindStateAsLevel(snapshot, kind)),
+                                   std::memory_order_relaxed);
+    }
+    table.kindMask.store(kindMask, std::memory_order_relaxed);
+    table.defaultLevel.store(static_cast<std::uint8_t>(snapshot.defaultSentryLoggerLevel),
+                             std::memory_order_relaxed);
+    auto limit = snapshot.logLevel;
+    if (snapshot.captureLogLevel < Level::Off && snapshot.captureLogLevel > limit)
+        limit = snapshot.captureLogLevel;
+    table.logLimit.store(static_cast<std::uint8_t>(static_cast<EnumType_t>(limit) + 1),
+                         std::memory_order_relaxed);
+    table.printLimit.store(static_cast<std::uint8_t>(static_cast<EnumType_t>(snapshot.logLevel) + 1),
+                           std::memory_order_relaxed);
+}
+
+template <typename Fn>
+void Settings::update(Fn&& modify)
+{
+    auto& publisher = getPublisher();
+    std::lock_guard<std::mutex> lock(publisher.mutex);
+    // Only writers delete snapshots, so the current one is safe to access under the lock
+    auto next = std::make_unique<Snapshot>(*loadCurrent());
+    modify(*next);
+    compileLineLayout(*next);
+    refreshEnablementTable(*next);
+    publisher.publishLocked(std::move(next));
+}
+
+
+/**
+    Settings
+*/
+bool SentryLogger::isKindAllowedSlow(Kind kind)
+{
+    return kindAllowed(*Settings::Reader(), kind);
+}
+
+SentryLogger::Level SentryLogger::getKindStateAsLevelSlow(Kind kind)
+{
+    return kindStateAsLevel(*Settings::Reader(), kind);
 }
 
 int Settings::getLoggerKindState(SentryLogger::Kind kind)
 {
     LOCAL_DEBUG( fmt::print("getKind_{}\n", static_cast<int>(kind)); )
-    if (static_cast<EnumType_t>(kind) < getNumberOfKinds())
-        return getKindsStateArray()[static_cast<EnumType_t>(kind)];
-    return 0;
+    return kindState(*Reader(), kind);
 }
 
-SentryLogger::Level Settings::getLoggerKindStateAsLevel(SentryLogger::Kind kind)
+void Settings::applyKindState(Snapshot& snapshot, SentryLogger::Kind kind, int value)
 {
-    EnumType_t rv = static_cast<EnumType_t>(Level::Off);
-    if (static_cast<EnumType_t>(kind) < getNumberOfKinds())
-        rv = static_cast<EnumType_t>(getKindsStateArray()[static_cast<EnumType_t>(kind)]);
-    if (rv > static_cast<EnumType_t>(Level::Off))
-        rv = static_cast<EnumType_t>(Level::Off);
-    return static_cast<SentryLogger::Level>(rv);
+    if (isKindValid(kind))
+        snapshot.kindsState[static_cast<EnumType_t>(kind)] = value;
 }
 
 void Settings::setLoggerKindState(SentryLogger::Kind kind, bool enableFlag /*=true*/)
 {
-    if (isKindValid(kind))
-        getKindsStateArray()[static_cast<EnumType_t>(kind)] = enableFlag;
-    LOCAL_DEBUG( fmt::print(FMT_STRING("SETKIND_B_{}={}/"), static_cast<int>(kind), enableFlag); getKindsStateArray(); fmt::print("\n"); )
+    LOCAL_DEBUG( fmt::print(FMT_STRING("SETKIND_B_{}={}\n"), static_cast<int>(kind), enableFlag); )
+    update([&](Snapshot& snapshot) { applyKindState(snapshot, kind, enableFlag); });
 }
 
 void Settings::setLoggerKindState(SentryLogger::Kind kind, int value)
 {
-    if (isKindValid(kind))
-        getKindsStateArray()[static_cast<EnumType_t>(kind)] = value;
-    LOCAL_DEBUG( fmt::print(FMT_STRING("SETKIND_I_{}={}/"), static_cast<int>(kind), value); getKindsStateArray(); fmt::print("\n"); )
+    LOCAL_DEBUG( fmt::print(FMT_STRING("SETKIND_I_{}={}\n"), static_cast<int>(kind), value); )
+    update([&](Snapshot& snapshot) { applyKindState(snapshot, kind, value); });
 }
 
 void Settings::setLoggerKindState(SentryLogger::Kind kind, SentryLogger::Level value)
 {
-    if (isKindValid(kind))
-        getKindsStateArray()[static_cast<EnumType_t>(kind)] = static_cast<int>(value);
+    update([&](Snapshot& snapshot) { applyKindState(snapshot, kind, static_cast<int>(value)); });
 }
 
 void Settings::setLogLevel(SentryLogger::Level level)
 {
-    if (level == Level::Default)
-    {
-        if (defaultSentryLoggerLevel_s > Level::Off)
-            defaultSentryLoggerLevel_s = Level::Off;
-        level = defaultSentryLoggerLevel_s;
-    }
-    LOCAL_DEBUG( fmt::print(FMT_STRING("setLogLevel {}->{}\n"), static_cast<int>(logLevel_s), static_cast<int>(level));)
-    if (level <= Level::Off)
-        logLevel_s = level;
+    set({{level, Operation::SetLogLevel}});
+}
+
+void Settings::setCaptureLogLevel(Level level)
+{
+    set({{level, Operation::SetCaptureLogLevel}});
+}
+
+SentryLogger::Level Settings::getCaptureLogLevel()
+{
+    return Reader()->captureLogLevel;
 }
 
 void Settings::setWatchLogLevel(Level level)
 {
-    if (level == Level::Default)
-    {
-        if (defaultSentryLoggerLevel_s > Level::Off)
-            defaultSentryLoggerLevel_s = Level::Off;
-        level = defaultSentryLoggerLevel_s;
-    }
-    if (level <= Level::Off)
-        watchLogLevel_s = level;
+    set({{level, Operation::SetWatchLogLevel}});
 }
 
 void Settings::enableStacktrace(bool flag /*= true*/)
 {
-    stackTraceEnabled_s = flag;
+    set({{Operation::EnableStackTraceTag{}, flag}});
 }
 
-void Settings::setPrintContextFlag(bool flag)
+void Settings::setDefaultLogLevel(SentryLogger::Level level)
 {
-    printContextFlag_s = flag;
+    set({{level, Operation::SetDefaultLogLevel}});
 }
 
-SentryLogger::Level Settings::getDefaultLevel()
+SentryLogger::Level Settings::getWatchLogLevel()
 {
-    return defaultSentryLoggerLevel_s;
+    return Reader()->watchLogLevel;
 }
 
-void Settings::setDefaultLogLevel(SentryLogger::Level level)
+bool Settings::isStacktraceEnabled()
 {
-    LOCAL_DEBUG( fmt::print(FMT_STRING("setDefaultLogLevel {}->{}\n"), static_cast<int>(logLevel_s), static_cast<int>(level));)
-    if (level <= Level::Off)
-        defaultSentryLoggerLevel_s = level;
+    return Reader()->stackTraceEnabled;
+}
+
+bool Settings::getPrintContextFlag()
+{
+    return Reader()->printContextFlag;
+}
+
+void Settings::setPrintContextFlag(bool flag)
+{
+    update([&](Snapshot& snapshot) { snapshot.printContextFlag = flag; });
+}
+
+void Settings::setNestedLevelFlag(bool flag)
+{
+    update([&](Snapshot& snapshot) { snapshot.isNestedLevelMode = flag; });
 }
 
 void Settings::setOutputHandler(OutputHandler handler)
 {
-    outputHandler_s = handler;
+    update([&](Snapshot& snapshot) { snapshot.outputHandler = handler; });
 }
 
 void Settings::setLoggerPrefix(std::string_view prefix)
 {
-    loggerPrefix_s = prefix;
+    update([&](Snapshot& snapshot) { snapshot.loggerPrefix = prefix; });
+}
+
+std::vector<Settings::LineField> Settings::getLineLayout()
+{
+    return Reader()->lineLayout;
+}
+
+void Settings::setLineLayout(std::vector<LineField> layout)
+{
+    update([&](Snapshot& snapshot) { snapshot.lineLayout = std::move(layout); });
 }
 
-std::vector<std::string>& Settings::cutoffNamespaces()
+std::vector<std::string> Settings::cutoffNamespaces()
 {
-    return cutoffNamespaces_s;
+    return Reader()->cutoffNamespaces;
 }
 
 void Settings::setCutoffNamespaces(std::vector<std::string> arr)
 {
-    cutoffNamespaces_s = std::move(arr);
+    update([&](Snapshot& snapshot) { snapshot.cutoffNamespaces = std::move(arr); });
+    nameGeneration_s.fetch_add(1, std::memory_order_relaxed);
 }
 
 void Settings::setKindNames(const std::vector<KindNamePair>& names)
 {
-    kindNamesStr.resize( static_cast<EnumType_t>(getNumberOfKinds()) );
-    for (auto p : names)
-    {
-        if (static_cast<EnumType_t>(p.kind_) < getNumberOfKinds())
-            kindNamesStr[ static_cast<unsigned>(p.kind_)] = p.name_;
-    }
+    update([&](Snapshot& snapshot) {
+        auto& kindNames = snapshot.kindNames;
+        kindNames.resize( static_cast<EnumType_t>(getNumberOfKinds()) );
+        for (auto& p : names)
+        {
+            if (static_cast<EnumType_t>(p.kind_) < getNumberOfKinds())
+                kindNames[ static_cast<unsigned>(p.kind_)] = p.name_;
+        }
 
-    LOCAL_DEBUG( for (std::size_t i=0; i< kindNamesStr.size(); i++) fmt::print("kind {} -> {}\n", i, kindNamesStr[i]); )
+        LOCAL_DEBUG( for (std::size_t i=0; i< kindNames.size(); i++) fmt::print("kind {} -> {}\n", i, kindNames[i]); )
+    });
 }
 
 Settings::Operation::Operation()
@@ -261,29 +702,62 @@ Settings::Operation::Operation(Settings::Operation::EnableStackTraceTag /*kind*/
     value_ = enableFlag;
 }
 
-void Settings::set( std::vector<Operation> operations )
+void Settings::apply(Snapshot& snapshot, const Operation& op)
 {
-    for (auto& op : operations)
-    {
-        LOCAL_DEBUG(fmt::print("set(type_{}) = {}\n", static_cast<int>(op.type_), static_cast<int>(op.enumValue_));)
-        if (op.type_==Settings::Operation::Type::SetKind)
-            setLoggerKindState(static_cast<SentryLogger::Kind>(op.enumValue_), op.value_);
-        else if (op.type_==Settings::Operation::Type::SetLogLevel)
-            setLogLevel(static_cast<SentryLogger::Level>(op.enumValue_));
-        else if (op.type_==Settings::Operation::Type::SetDefaultLogLevel)
-            setDefaultLogLevel(static_cast<SentryLogger::Level>(op.enumValue_));
-        else if (op.type_==Settings::Operation::Type::SetWatchLogLevel)
-            setWatchLogLevel( static_cast<SentryLogger::Level>(op.enumValue_));
-        else
-            enableStacktrace(op.value_);
+    LOCAL_DEBUG(fmt::print("set(type_{}) = {}\n", static_cast<int>(op.type_), static_cast<int>(op.enumValue_));)
+    if (op.type_ == Operation::SetKind)
+    {
+        applyKindState(snapshot, static_cast<SentryLogger::Kind>(op.enumValue_), op.value_);
+        return;
     }
+    if (op.type_ == Operation::SetEnableStacktraceFlag)
+    {
+        snapshot.stackTraceEnabled = op.value_;
+        return;
+    }
+
+    auto level = static_cast<SentryLogger::Level>(op.enumValue_);
+    if (op.type_ == Operation::SetDefaultLogLevel)
+    {
+        if (level <= Level::Off)
+            snapshot.defaultSentryLoggerLevel = level;
+        return;
+    }
+
+    if (level == Level::Default)
+    {
+        if (snapshot.defaultSentryLoggerLevel > Level::Off)
+            snapshot.defaultSentryLoggerLevel = Level::Off;
+        level = snapshot.defaultSentryLoggerLevel;
+    }
+    if (level > Level::Off)
+        return;
+    if (op.type_ == Operation::SetWatchLogLevel)
+        snapshot.watchLogLevel = level;
+    else if (op.type_ == Operation::SetCaptureLogLevel)
+        snapshot.captureLogLevel = level;
+    else
+        snapshot.logLevel = level;
+}
+
+void Settings::set( std::vector<Operation> operations )
+{
+    update([&](Snapshot& snapshot) {
+        for (auto& op : operations)
+            apply(snapshot, op);
+    });
 }
 
 Settings::TemporarySettings::TemporarySettings(std::vector<Settings::Operation> operations,
      bool rollbackOnlyChanged/* = true*/)
          : operations_( std::move(operations) )
 {
-    // Only different values are remembered
+    // Only different values are remembered.
+    // Each operation is compared with the state modified by the previous ones,
+    // but the whole batch is published once.
+    std::vector<Operation> toApply;
+    toApply.reserve(operations_.size());
+    Snapshot state = *Reader();
 
     size_t idx = 0;
     for (auto& op : operations_ )
@@ -294,44 +768,42 @@ Settings::TemporarySettings::TemporarySettings(std::vector<Settings::Operation>
             //@todo -- should be int
             bool flag = op.value_;
             LOCAL_DEBUG(fmt::print("temp_set_kind{}={}\n", static_cast<int>(kind), flag);)
-            if (rollbackOnlyChanged && flag == Settings::isKindAllowed(kind))
+            if (rollbackOnlyChanged && flag == kindAllowed(state, kind))
                 continue;
-            
-            Settings::setLoggerKindState(kind, flag);
+
+            toApply.push_back(Operation(kind, flag));
             operations_[idx++] = Operation(kind, !flag);
         }
         else if (op.type_ == Operation::SetEnableStacktraceFlag)
         {
             bool flag = op.value_;
-            if (rollbackOnlyChanged && flag == Settings::isStacktraceEnabled())
+            if (rollbackOnlyChanged && flag == state.stackTraceEnabled)
                 continue;
-            
-            Settings::enableStacktrace(flag);
+
+            toApply.push_back(Operation(Operation::EnableStackTraceTag{}, flag));
             operations_[idx++] = Operation(Operation::EnableStackTraceTag{}, !flag);
         }
         else
         {
-            auto curLevel = Settings::getLogLevel();
-            if (op.type_==Operation::SetWatchLogLevel) 
-                curLevel = Settings::getWatchLogLevel();
-            else if (op.type_==Operation::SetDefaultLogLevel) 
-                curLevel = Settings::defaultSentryLoggerLevel_s;
+            auto curLevel = state.logLevel;
+            if (op.type_==Operation::SetWatchLogLevel)
+                curLevel = state.watchLogLevel;
+            else if (op.type_==Operation::SetDefaultLogLevel)
+                curLevel = state.defaultSentryLoggerLevel;
+            else if (op.type_==Operation::SetCaptureLogLevel)
+                curLevel = state.captureLogLevel;
 
         LOCAL_DEBUG(fmt::print("temp_set_level {}->{}\n", static_cast<int>(curLevel), static_cast<int>(op.enumValue_));)
             auto newLevel = static_cast<SentryLogger::Level>(op.enumValue_);
             if (rollbackOnlyChanged && (curLevel == newLevel || newLevel > SentryLogger::Level::Off))
                 continue;
+            toApply.push_back(op);
             operations_[idx++] = Operation(curLevel, op.type_);
-
-            if (op.type_==Operation::SetWatchLogLevel) 
-                Settings::setWatchLogLevel(newLevel);
-            else if (op.type_==Operation::SetDefaultLogLevel) 
-                Settings::setDefaultLogLevel(newLevel);
-            else
-                Settings::setLogLevel(newLevel);
         }
+        apply(state, toApply.back());
     }
     operations_.resize(idx);
+    Settings::set( std::move(toApply) );
 }
 
 
@@ -347,19 +819,96 @@ Settings::TemporarySettings::~TemporarySettings()
 */
 namespace
 {
-double getCurTimestampAsDouble()
+// Monotonic timestamp in ns
+std::int64_t getCurTimestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Wall clock timestamp in ns
+std::int64_t getWallTimestamp()
 {
     using namespace std::chrono;
-    auto now = system_clock::now();
-    double t =  duration_cast<duration<double>>(now.time_since_epoch()).count();
-    return t;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Append decimal number padded with zeros to the given width
+void appendNumber(std::string& out, long long value, int width = 0)
+{
+    char buf[24];
+    auto* end = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+    auto size = static_cast<int>(end - buf);
+    if (size < width)
+        out.append(static_cast<std::size_t>(width - size), '0');
+    out.append(buf, end);
+}
+
+// "HH:MM:SS.uuuuuu " in local time
+void appendTimestamp(std::string& out, std::int64_t timeNs)
+{
+    // localtime_r() is called only once per second
+    struct Cache
+    {
+        std::int64_t second = -1;
+        char hms[8];
+    };
+    thread_local Cache cache_t;
+
+    auto second = timeNs / 1000000000;
+    if (second != cache_t.second)
+    {
+        std::time_t t = static_cast<std::time_t>(second);
+        std::tm tm{};
+        ::localtime_r(&t, &tm);
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d", tm.tm_hour, tm.tm_min, tm.tm_sec);
+        std::memcpy(cache_t.hms, buf, sizeof(cache_t.hms));
+        cache_t.second = second;
+    }
+    out.append(cache_t.hms, sizeof(cache_t.hms));
+    out.push_back('.');
+    appendNumber(out, (timeNs / 1000) % 1000000, 6);
+    out.push_back(' ');
 }
 
-// Aux function to controllable lifetime and initialize of "last_s"
-SentryLogger** getLastSentryPtr()
+std::string_view getLevelName(SentryLogger::Level level)
 {
-    static SentryLogger* last_s = SentryLogger::getRoot();
-    return &last_s;
+    static constexpr std::string_view kNames[] = {"FATAL", "ERROR", "WARN", "IMPT", "INFO", "DEBUG", "TRACE"};
+    auto idx = static_cast<std::size_t>(level);
+    return (idx < std::size(kNames)) ? kNames[idx] : "?";
+}
+
+constexpr auto kTimingFlags = static_cast<SentryLogger::EnumType_t>(SentryLogger::Flags::Timer)
+                              | static_cast<SentryLogger::EnumType_t>(SentryLogger::Flags::Stats);
+
+using impl::sentryStack_t;
+
+// Lines of the scope with Flags::TailBuffer (see SentryLogger::InitArgs::tailThresholdUs)
+struct TailBuffer
+{
+    struct Line
+    {
+        SentryLogger::Level level;
+        SentryLogger::Kind kind;
+        std::size_t size;
+    };
+
+    const SentryLogger* owner = nullptr;    // outermost sentry with the flag (nullptr = not active)
+    bool failed = false;                    // Error or Fatal line is collected
+    std::int64_t finishBefore = 0;          // steady clock (ns), 0 = no latency threshold
+    std::string arena;                      // formatted lines one by one (capacity is reused)
+    std::vector<Line> lines;
+};
+
+thread_local TailBuffer tailBuffer_t{};
+
+// Sentry at given position of the current thread stack
+SentryLogger* getStackItem(int idx)
+{
+    if (idx >= DEBUGLOG_SENTRY_STACK_DEPTH)
+        idx = DEBUGLOG_SENTRY_STACK_DEPTH - 1;
+    return (idx > 0) ? sentryStack_t.items[idx] : SentryLogger::getRoot();
 }
 
 } // anonymous namespace
@@ -395,24 +944,24 @@ SentryLogger::SentryLogger(RootTag)
     prettyName_ = nullptr;
     flags_ = SentryLogger::Flags::SuppressBorders;
     // for "root record the initial default level is assigned but could be overriden later
-    logLevel_ = Settings::defaultSentryLoggerLevel_s;
+    logLevel_ = Settings::getDefaultLevel();
     mainLogLevel_ = logLevel_;
     kind_ = SentryLogger::Kind::Default;
-    prevSentry_ = nullptr;
+    stackIdx_ = 0;
+    initFullState();
 }
 
-// Main ctor
-SentryLogger::SentryLogger(const char* prettyName,
-                           std::string_view name /*=""*/,
-                           InitArgs args /*={}*/)
-    : flags_(args.flags)
-    , mainLogLevel_(args.enabled ? transformLogLevel(args.level) : Level::Off)
-    , kind_(static_cast<EnumType_t>(args.kind) >= getNumberOfKinds() ? Kind::Off
-                                                                     : args.kind)
-    , relatedObj_(args.object)
-    , contextName_(name)
-    , prettyName_(prettyName)
+// Main ctor (the slow path)
+void SentryLogger::init(const char* prettyName, std::string_view name, InitArgs args)
 {
+    initFullState();
+    flags_ = args.flags;
+    mainLogLevel_ = args.enabled ? transformLogLevel(args.level) : Level::Off;
+    kind_ = static_cast<EnumType_t>(args.kind) >= getNumberOfKinds() ? Kind::Off : args.kind;
+    relatedObj_ = args.object;
+    contextName_ = name.empty() ? name : internName(name);
+    prettyName_ = prettyName;
+
     if (kind_ < Kind::Off)
          kind_ = Kind::Off;
 
@@ -420,15 +969,16 @@ SentryLogger::SentryLogger(const char* prettyName,
     LOCAL_DEBUG( fmt::print(FMT_STRING("ctor SENTRY - {}|{} | enabled_{}| kind_{}->{}|level_{}->{}\n"), name, prettyName?prettyName:"null", args.enabled, static_cast<int>(args.kind), static_cast<int>(kind_), static_cast<int>(args.level), static_cast<int>(logLevel_)); )
 
     if (!prettyName_ && checkFlags(Flags::AppendContextName))
-         contextName_ = getLast()->getContextName() + "--" + contextName_;
+         contextName_ = ContextNames::get().join(getLast()->getContextName(), contextName_);
 
     // Do not place disabled to the sentries stack.
     // That is the way to make it invisible
     if (args.enabled)
     {
-        currentLevel_s++;
-        prevSentry_ = *getLastSentryPtr();
-        *getLastSentryPtr() = this;
+        auto& stack = sentryStack_t;
+        stackIdx_ = ++stack.depth;
+        if (stackIdx_ < DEBUGLOG_SENTRY_STACK_DEPTH)
+            stack.items[stackIdx_] = this;
     }
     else
     {
@@ -436,9 +986,9 @@ SentryLogger::SentryLogger(const char* prettyName,
     }
 
     if (logLevel_ == Level::Default)
-        logLevel_ = Settings::defaultSentryLoggerLevel_s;
+        logLevel_ = Settings::getDefaultLevel();
     else if (logLevel_ == Level::This || logLevel_ == Level::Parent)
-        logLevel_ = prevSentry_->getLogLevel();
+        logLevel_ = getParent()->getLogLevel();
 
     if (relatedObj_ && logLevel_ != Level::Off)
         logobjects::registerObject(kind_, relatedObj_);
@@ -446,8 +996,19 @@ SentryLogger::SentryLogger(const char* prettyName,
         relatedObj_ = nullptr;
 
     // at the end to minimize impact
-    if (checkFlags(Flags::Timer))
-        startTime_ = getCurTimestampAsDouble();
+    if (checkFlags(static_cast<Flags>(kTimingFlags)))
+        startTime_ = getCurTimestamp();
+    if (trace::isActive() && args.enabled)
+        traceStart_ = trace::now();
+    if (checkFlags(Flags::TailBuffer) && args.enabled && !tailBuffer_t.owner)
+    {
+        auto& tail = tailBuffer_t;
+        tail.owner = this;
+        tail.failed = false;
+        tail.finishBefore = args.tailThresholdUs
+                                ? getCurTimestamp() + static_cast<std::int64_t>(args.tailThresholdUs) * 1000
+                                : 0;
+    }
 }
 
 // Ctor of "silent" sentry
@@ -460,51 +1021,77 @@ SentryLogger::SentryLogger(Level level,
     flags_ = static_cast<Flags>(flags_ | (appendContextFlag ? Flags::AppendContextName : Flags::Default));
 }
 
-SentryLogger::~SentryLogger()
+// Dtor (the slow path)
+void SentryLogger::leave()
 {
-    int decrementLevel = 0;
-
-    // Exclude from chain
-    if (*getLastSentryPtr() == this)
-    {
-        decrementLevel = 1;
-        *getLastSentryPtr() = prevSentry_;
-    }
-    else
+    // Dormant sentry hasn't printed the enter line and has no full state
+    if (dormant_)
     {
-        // something strange happens. deallocate not in order of allocation
-        SentryLogger* cur = *getLastSentryPtr();
-        for (; !cur; cur = cur->prevSentry_)
-        {
-            if (cur->prevSentry_ == this)
-            {
-                decrementLevel = 1;
-                cur->prevSentry_ = cur->prevSentry_->prevSentry_;
-                break;
-            }
-        }
+        removeFromStack();
+        return;
     }
 
     if (relatedObj_)
         logobjects::deregisterObject(kind_, relatedObj_);
 
+    if (checkFlags(Flags::Stats))
+        recordStats();
+    if (traceStart_ && trace::isActive() && isScopeAllowed())
+        trace::complete(getContextName(),
+                        traceStart_,
+                        trace::now(),
+                        extra_ ? std::string_view(extra_->traceArgs) : std::string_view(),
+                        extra_ ? std::string_view(extra_->returnValueStr) : std::string_view());
+
     if (isAllowed(Stage::Leave))
     {
-        std::string suffix;
-
-        // Print leave message
+        // Print leave message (suffix is on the stack unless the return value is huge)
+        fmt::memory_buffer suffix;
         if (checkFlags(Flags::Timer))
         {
-            double finTime = getCurTimestampAsDouble();
-            suffix = TOSTR_FMT(". Processing time = {:.4f}s", finTime - startTime_);
+            double duration = static_cast<double>(getCurTimestamp() - startTime_) / 1e9;
+            fmt::format_to(std::back_inserter(suffix), FMT_STRING(". Processing time = {:.4f}s"), duration);
         }
-        if (!returnValueStr_.empty())
-            suffix += TOSTR_FMT(". RV = {}", returnValueStr_);
-        write(kind_, logLevel_, '<', getContextName(), "", ">> Leave scope", suffix);
+        if (extra_ && !extra_->returnValueStr.empty())
+            fmt::format_to(std::back_inserter(suffix), FMT_STRING(". RV = {}"), extra_->returnValueStr);
+        write(kind_,
+              getBordersLevel(),
+              '<',
+              getContextName(),
+              "",
+              ">> Leave scope",
+              std::string_view(suffix.data(), suffix.size()));
     }
+    if (tailBuffer_t.owner == this)
+        flushTail();
+    delete extra_;
 
-    currentLevel_s -= decrementLevel;
-    LOCAL_DEBUG( fmt::print(FMT_STRING("dtor SENTRY - {} | kind_{}|level_{}|nestLevel={}\n"), getContextName(), static_cast<int>(kind_), static_cast<int>(logLevel_), currentLevel_s); )
+    // Exclude from the stack (leave message above is printed with the sentry nesting level)
+    removeFromStack();
+    LOCAL_DEBUG( fmt::print(FMT_STRING("dtor SENTRY - {} | kind_{}|level_{}|nestLevel={}\n"), getContextName(), static_cast<int>(kind_), static_cast<int>(logLevel_), sentryStack_t.depth); )
+}
+
+void SentryLogger::removeFromStack()
+{
+    if (stackIdx_ > 0)
+    {
+        auto& stack = sentryStack_t;
+        if (stackIdx_ < stack.depth && stackIdx_ < DEBUGLOG_SENTRY_STACK_DEPTH)
+        {
+            // something strange happens. deallocate not in order of allocation
+            int top = std::min(stack.depth, DEBUGLOG_SENTRY_STACK_DEPTH - 1);
+            for (int i = stackIdx_; i < top; i++)
+            {
+                stack.items[i] = stack.items[i + 1];
+                stack.items[i]->stackIdx_ = i;
+            }
+        }
+        if (stack.suppressedFrom > stackIdx_)
+            stack.suppressedFrom--;
+        else if (stack.suppressedFrom == stackIdx_)
+            stack.suppressedFrom = 0;
+        stack.depth--;
+    }
 }
 
 SentryLogger* SentryLogger::getRoot()
@@ -515,7 +1102,17 @@ SentryLogger* SentryLogger::getRoot()
 
 SentryLogger* SentryLogger::getLast()
 {
-    return *getLastSentryPtr();
+    return getStackItem(sentryStack_t.depth);
+}
+
+SentryLogger* SentryLogger::getParent() const
+{
+    // Not placed to the stack sentry refers to the top of stack
+    if (stackIdx_ < 0)
+        return getLast();
+    if (stackIdx_ == 0)
+        return nullptr;
+    return getStackItem(stackIdx_ - 1);
 }
 
 void SentryLogger::printStackTrace()
@@ -525,7 +1122,7 @@ void SentryLogger::printStackTrace()
 
 void SentryLogger::printStackTrace(StackTraceArgs args, Level level /*= Level::This*/)
 {
-    if (!Settings::stackTraceEnabled_s && !args.enforce)
+    if (!Settings::isStacktraceEnabled() && !args.enforce)
         return;
 
     level = transformLogLevel(level);
@@ -533,7 +1130,7 @@ void SentryLogger::printStackTrace(StackTraceArgs args, Level level /*= Level::T
     if (!isAllowed(Stage::Enter, level, kind))
         return;
 
-    auto& contextName = getContextName();
+    auto contextName = getContextName();
 
     // Ask for backtrace (and ignore this function)
     auto arrStr = ::tsv::debuglog::getStackTrace(args.depth, args.skip + 1);
@@ -546,94 +1143,176 @@ void SentryLogger::print(std::string_view content /*=""*/)
     write(getContextName(), SentryLogger::Stage::Event, logLevel_, content, "");
 }
 
-const std::string& SentryLogger::getContextName()
+std::string SentryLogger::makeContextName(const char* prettyName)
 {
-    if (prettyName_)
+    std::string name;
+    if (prettyName[0]=='|')
     {
-        if (contextName_.empty())
+        // path given
+        std::string_view s{prettyName};
+        auto pos = s.rfind("/");
+        if (pos != std::string_view::npos)
+            name = s.substr(pos+1);
+    }
+    else if (prettyName[0])
+    {
+        // Function Name given
+        name = extractFuncName(prettyName);
+        Settings::Reader settings;
+        for (const std::string& s : settings->cutoffNamespaces)
         {
-            if (prettyName_[0]=='|')
-            {
-                // path given
-                std::string_view s{prettyName_};
-                auto pos = s.rfind("/");
-                if (pos != std::string_view::npos)
-                    contextName_ = s.substr(pos+1);
-            }
-            else if (prettyName_[0])
+            if (startsWith(name,s))
             {
-                // Function Name given
-                contextName_ = extractFuncName(prettyName_);
-                for (const std::string& s : Settings::cutoffNamespaces())
-                {
-                    if (startsWith(contextName_,s))
-                    {
-                        contextName_ = std::string_view(contextName_).substr(s.size());
-                        break;
-                    }
-                }
+                name = std::string_view(name).substr(s.size());
+                break;
             }
         }
+    }
+    return name;
+}
+
+std::string_view SentryLogger::getContextName()
+{
+    if (prettyName_ || rawName_)
+    {
+        auto& names = ContextNames::get();
+        if (rawName_)
+        {
+            contextName_ = names.intern(contextName_);
+            rawName_ = false;
+        }
+        if (contextName_.empty())
+            contextName_ = names.resolve(prettyName_, makeContextName);
         if (checkFlags(Flags::AppendContextName))
-            contextName_ = prevSentry_->getContextName() + "--" + contextName_;
+            contextName_ = names.join(getParent()->getContextName(), contextName_);
         prettyName_ = nullptr;
     }
     return contextName_;
 }
 
+void SentryLogger::recordStats()
+{
+    // Collected for the enabled sentries even if their borders are not printed
+    if (!isScopeAllowed())
+        return;
+    auto duration = static_cast<std::uint64_t>(std::max<std::int64_t>(getCurTimestamp() - startTime_, 0));
+
+    // Name of function is resolved only once per thread, so key the statistics by the site if possible
+    if (prettyName_ && contextName_.empty() && !checkFlags(Flags::AppendContextName))
+    {
+        stats::recordSite(prettyName_,
+                          [](const void* site) { return makeContextName(static_cast<const char*>(site)); },
+                          duration);
+    }
+    else
+        stats::record(getContextName(), duration);
+}
+
 SentryLogger::Level SentryLogger::transformLogLevel(Level level) const
 {
     if (level <= Level::Off)
         return level;
     if (level == Level::Default)
-        return Settings::defaultSentryLoggerLevel_s;
+        return Settings::getDefaultLevel();
     if (level == Level::This)
         return logLevel_;
     if (level == Level::Parent)
-        return prevSentry_ ? prevSentry_->logLevel_ : logLevel_;
+    {
+        auto* parent = getParent();
+        return parent ? parent->logLevel_ : logLevel_;
+    }
     return level;
 }
 
+void SentryLogger::wake()
+{
+    if (!dormant_)
+        return;
+    dormant_ = false;
+    initFullState();
+    // The fast path skips validation of the custom kind
+    if (static_cast<EnumType_t>(kind_) >= getNumberOfKinds())
+        kind_ = Kind::Off;
+}
+
+std::string_view SentryLogger::internName(std::string_view name)
+{
+    return ContextNames::get().intern(name);
+}
+
 void SentryLogger::setLogLevel(Level level)
 {
+    wake();
     mainLogLevel_ = transformLogLevel(level);
     logLevel_ = mainLogLevel_;
 }
 
+void SentryLogger::suppressSubtree()
+{
+    setLogLevel(Level::Off);
+    // Not placed to the stack sentry has no subtree
+    auto& stack = sentryStack_t;
+    if (stackIdx_ > 0 && !stack.suppressedFrom)
+        stack.suppressedFrom = stackIdx_;
+}
+
+void SentryLogger::forceSite()
+{
+    // Not placed to the stack, so nothing could be printed on its behalf
+    if (stackIdx_ < 0)
+        return;
+    wake();
+    forcedBorders_ = true;
+}
+
 void SentryLogger::setReturnValueStr(std::string rv)
 {
-    returnValueStr_ = rv;
+    // Dormant sentry prints no leave line, so the value is never used
+    if (dormant_)
+        return;
+    getExtra().returnValueStr = std::move(rv);
+}
+
+SentryLogger::Extra& SentryLogger::getExtra()
+{
+    if (!extra_)
+        extra_ = new Extra;
+    return *extra_;
 }
 
-inline bool SentryLogger::checkFlags(Flags test) const
+void SentryLogger::initFullState()
 {
-    return (static_cast<SentryLogger::EnumType_t>(flags_)
-            & static_cast<SentryLogger::EnumType_t>(test));
+    forcedBorders_ = false;
+    relatedObj_ = nullptr;
+    startTime_ = 0;
+    traceStart_ = 0;
+    extra_ = nullptr;
 }
 
 void SentryLogger::setFlag(SentryLogger::Flags flags, bool enable /*= true*/)
 {
-    if (static_cast<SentryLogger::EnumType_t>(flags)
-        & static_cast<SentryLogger::EnumType_t>(Flags::Timer))
+    wake();
+    auto timingFlags = static_cast<EnumType_t>(flags) & kTimingFlags;
+    if (enable)
     {
-        if (enable)
-        {
-            if (!checkFlags(Flags::Timer))
-                startTime_ = getCurTimestampAsDouble();
-        }
-        else if (checkFlags(Flags::Timer))
+        // Timer and Stats share the start time
+        if (timingFlags && !checkFlags(static_cast<Flags>(kTimingFlags)))
+            startTime_ = getCurTimestamp();
+    }
+    else
+    {
+        if ((timingFlags & static_cast<EnumType_t>(Flags::Timer)) && checkFlags(Flags::Timer))
         {
             if (isAllowed(Stage::Event))
             {
-                double fin = getCurTimestampAsDouble();
-                write(getContextName(),
-                      Stage::Event,
-                      logLevel_,
-                      TOSTR_FMT("Processed time: {:.4f}s",
-                                fin - startTime_),
-                      "");
+                double duration = static_cast<double>(getCurTimestamp() - startTime_) / 1e9;
+                fmt::memory_buffer body;
+                fmt::format_to(std::back_inserter(body), FMT_STRING("Processed time: {:.4f}s"), duration);
+                write(getContextName(), Stage::Event, logLevel_, std::string_view(body.data(), body.size()), "");
             }
         }
+        if ((timingFlags & static_cast<EnumType_t>(Flags::Stats)) && checkFlags(Flags::Stats))
+            recordStats();
     }
 
     if (enable)
@@ -648,46 +1327,18 @@ void SentryLogger::setFlag(SentryLogger::Flags flags, bool enable /*= true*/)
     }
 }
 
-bool SentryLogger::isAllowedStage(SentryLogger::Stage stage) const
-{
-    LOCAL_DEBUG( fmt::print(FMT_STRING("ISSTAGE=force_{}/stage_{}\n"), checkFlags(Flags::Force), isStageAllowed(flags_, stage)); )
-    return checkFlags(Flags::Force) || isStageAllowed(flags_, stage);
-}
-
-bool SentryLogger::isAllowed(SentryLogger::Stage stage, SentryLogger::Level level, SentryLogger::Kind kind) const
-{
-    LOCAL_DEBUG( fmt::print(FMT_STRING("IS=level_{}/{}|force_{}|stage_{}|kind_{}/{}\n"), level, Settings::logLevel_s, checkFlags(Flags::Force), isStageAllowed(flags_, stage), static_cast<unsigned>(kind), Settings::isKindAllowed(kind));)    
-    return level <= Settings::logLevel_s
-           && ( checkFlags(Flags::Force)
-                || (isStageAllowed(flags_, stage) && Settings::isKindAllowed(kind)));
-}
-
-bool SentryLogger::isAllowedAndSetTempLevel(SentryLogger::Stage stage, SentryLogger::Level level)
-{
-    LOCAL_DEBUG( fmt::print(FMT_STRING("IS&SET=level_{}/{}|force_{}|stage_{}|kind_{}/{}\n"), level, Settings::logLevel_s, checkFlags(Flags::Force), isStageAllowed(flags_, stage), static_cast<unsigned>(kind_), Settings::isKindAllowed(kind_)); )
-    if (level > Settings::logLevel_s)
-        return false;
-
-    if (checkFlags(Flags::Force)
-        || (isStageAllowed(flags_, stage) && Settings::isKindAllowed(kind_)))
-    {
-        // Only update current loglevel only for allowed because it is reseted in write()
-        logLevel_ = level;
-        return true;
-    }
-    return false;
-}
-
 SentryLogger::EnterHelper::EnterHelper(std::string_view content /*=""*/)
 {
     // We can rely on the SentryLogger object (to which this helper is related), never being hidden in the stack.
     // That is because hiding could happen for .enabled=false, and then the "if" condition in the macro will not pass the control flow here.
     SentryLogger* last = SentryLogger::getLast();
-    last->write(last->getContextName(), SentryLogger::Stage::Enter, last->logLevel_, content, "");
+    if (last->traceStart_)
+        last->getExtra().traceArgs = content;
+    last->write(last->getContextName(), SentryLogger::Stage::Enter, last->getBordersLevel(), content, "");
 }
 
 // Isolated function to make possible to extend its logic if needed in future
-const std::string& LastSentryLogger::getContextName()
+std::string_view LastSentryLogger::getContextName()
 {
     return SentryLogger::getLast()->getContextName();
 }
@@ -713,7 +1364,7 @@ void LastSentryLogger::printStackTrace(StackTraceArgs args,
     if (!last->isAllowed(SentryLogger::Event, level, kind))
         return;
 
-    auto& contextName = getContextName();
+    auto contextName = getContextName();
 
     // Ask for backtrace (and ignore this function)
     auto arrStr = ::tsv::debuglog::getStackTrace(args.depth, args.skip + 1);
@@ -727,6 +1378,11 @@ void LastSentryLogger::print(std::string_view content /*=""*/)
     last->write(getContextName(), SentryLogger::Stage::Event, last->getLogLevel(), content, "");
 }
 
+void LastSentryLogger::printDeferred(async::RenderFn render, async::FillFn fill, const void* context)
+{
+    SentryLogger::getLast()->printDeferred(render, fill, context);
+}
+
 void SentryLogger::write(std::string_view contextName,
                          Stage stage,
                          Level level,
@@ -740,7 +1396,7 @@ void SentryLogger::write(std::string_view contextName,
               '>',
               contextName,
               ">> Enter ",
-              (suffix.empty() && body.empty()) ? std::string("scope") : body,
+              (suffix.empty() && body.empty()) ? std::string_view("scope") : body,
               suffix);
     }
     else
@@ -750,6 +1406,84 @@ void SentryLogger::write(std::string_view contextName,
     }
 }
 
+void SentryLogger::setOrigin(LineInfo& info)
+{
+    const auto& tag = getThreadTag();
+    info.time = getWallTimestamp();
+    info.threadId = tag.id;
+    info.threadName = tag.name;
+}
+
+void SentryLogger::formatLine(std::string& out,
+                              const LineInfo& info,
+                              std::string_view contextName,
+                              std::string_view prefix,
+                              std::string_view body,
+                              std::string_view suffix)
+{
+    Settings::formatLine(out, *Settings::Reader(), info, contextName, prefix, body, suffix);
+}
+
+void Settings::formatLine(std::string& out,
+                          const Snapshot& snapshot,
+                          const SentryLogger::LineInfo& info,
+                          std::string_view contextName,
+                          std::string_view prefix,
+                          std::string_view body,
+                          std::string_view suffix)
+{
+    LOCAL_DEBUG(fmt::print("write|{}|{}|{}|{}|\n", contextName, prefix, body, suffix);)
+    for (const auto& op : snapshot.lineOps)
+    {
+        switch (op.field)
+        {
+            case LineField::Prefix:
+                out.append(op.text);
+                break;
+            case LineField::Timestamp:
+                appendTimestamp(out, info.time ? info.time : getWallTimestamp());
+                break;
+            case LineField::ThreadId:
+                out.push_back('[');
+                appendNumber(out, info.threadId ? info.threadId : getThreadTag().id);
+                out.append("] ");
+                break;
+            case LineField::ThreadName:
+                out.push_back('[');
+                out.append(info.threadId ? info.threadName : getThreadTag().name);
+                out.append("] ");
+                break;
+            case LineField::Level:
+                out.append(getLevelName(info.level));
+                out.push_back(' ');
+                break;
+            case LineField::Kind:
+            {
+                const auto& kindNames = snapshot.kindNames;
+                auto idx = static_cast<std::size_t>(info.kind);
+                if (idx < kindNames.size())
+                    out.append(kindNames[idx]);
+                break;
+            }
+            case LineField::Nested:
+                // Nesting level as 2+ digits, then the marker repeated up to the level
+                appendNumber(out, info.depth, 2);
+                out.append(static_cast<std::size_t>(std::max(info.depth, 1)), info.nestedSym);
+                break;
+            case LineField::Context:
+                out.push_back('{');
+                out.append(contextName);
+                out.push_back('}');
+                break;
+            case LineField::Body:
+                out.append(prefix);
+                out.append(body);
+                out.append(suffix);
+                break;
+        }
+    }
+}
+
 void SentryLogger::write(Kind kind,
                          Level level,
                          char nestedSym,
@@ -758,31 +1492,231 @@ void SentryLogger::write(Kind kind,
                          std::string_view body,
                          std::string_view suffix)
 {
-    if (!Settings::outputHandler_s)
-        return;
     if (body.empty() && suffix.empty())
         return;
+    // Level is rechecked because the log level could be changed after the check in the macro
+    if (!enablement_s.isLevelPrinted(level) && enablement_s.isLevelAllowed(level))
+    {
+        recorder::impl::capture(level, kind, nestedSym, sentryStack_t.depth, contextName, prefix, body, suffix);
+        return;
+    }
+    triggerRecorder(level);
 
-    LOCAL_DEBUG(fmt::print("write|{}|{}|{}|{}|\n", contextName, prefix, body, suffix);)
-    std::string nested;
-    if (Settings::isNestedLevelMode_s)
+    if (nestedSym == ' ' && trace::isActive())
+        trace::instant(suffix.empty() ? std::string(body) : std::string(body).append(suffix), contextName);
+
+    auto& tail = tailBuffer_t;
+    if (tail.owner)
     {
-        std::string fmtStr;
-        fmtStr.append("{0:0>2}{1:").append(1, nestedSym).append(">{0}}");
-        nested = TOSTR_FMT(fmtStr, currentLevel_s, nestedSym);
+        auto offset = tail.arena.size();
+        formatLine(tail.arena, {sentryStack_t.depth, kind, level, nestedSym}, contextName, prefix, body, suffix);
+        tail.lines.push_back({level, kind, tail.arena.size() - offset});
+        if (level <= Level::Error)
+            tail.failed = true;
+        return;
     }
 
-    // Format ""{0_LoggerPrefix}{1_NestedCombo}{2_KindName}{{{3_Context}}}{4_Prefix}{5_Body}{6_Suffix}"
-    auto s = TOSTR_FMT("{0}{1}{2}{{{3}}}{4}{5}{6}",
-                       Settings::loggerPrefix_s,                           // 0
-                       nested,                                             // 1
-                       (Settings::printKindFlag_s) ? kindNamesStr[static_cast<EnumType_t>(kind)] : std::string_view(),  // 2
-                       (Settings::printContextFlag_s && !contextName.empty()) ? contextName : "",       // 3
-                       prefix,                                             // 4
-                       body,                                               // 5
-                       suffix);                                            // 6
+    emit({sentryStack_t.depth, kind, level, nestedSym}, contextName, prefix, body, suffix);
+}
+
+void SentryLogger::flushTail()
+{
+    auto& tail = tailBuffer_t;
+    tail.owner = nullptr;
+    bool slow = tail.finishBefore && getCurTimestamp() > tail.finishBefore;
+    auto handler = Settings::Reader()->outputHandler;
+    if (handler && (tail.failed || slow))
+    {
+        std::string_view arena{tail.arena};
+        for (const auto& line : tail.lines)
+        {
+            auto s = arena.substr(0, line.size);
+            arena.remove_prefix(line.size);
+            if (!async::push(handler, line.level, line.kind, s))
+                handler(line.level, line.kind, s);
+        }
+    }
+    tail.arena.clear();
+    tail.lines.clear();
+}
+
+namespace
+{
+
+// Per-thread buffer which keeps its capacity between the lines
+struct ScratchSlot
+{
+    std::string text;
+    bool busy = false;
+};
+
+// Cleared buffer of the slot for the scope. Nested use (e.g. the output handler prints
+// something itself) gets its own string instead.
+class Scratch
+{
+public:
+    explicit Scratch(ScratchSlot& slot)
+        : slot_(slot.busy ? nullptr : &slot)
+    {
+        if (slot_)
+            slot_->busy = true;
+        str().clear();
+    }
+    ~Scratch()
+    {
+        if (slot_)
+            slot_->busy = false;
+    }
+    Scratch(const Scratch&) = delete;
+    Scratch& operator=(const Scratch&) = delete;
+
+    std::string& str() { return slot_ ? slot_->text : own_; }
+
+private:
+    ScratchSlot* slot_;
+    std::string own_;
+};
+
+thread_local ScratchSlot lineSlot_t;        // formatted line
+thread_local ScratchSlot payloadSlot_t;     // serialized arguments of SAY_*_DEFERRED
+thread_local ScratchSlot bodySlot_t;        // rendered body of SAY_*_DEFERRED
+
+}  // namespace
+
+void SentryLogger::emit(const LineInfo& info,
+                        std::string_view contextName,
+                        std::string_view prefix,
+                        std::string_view body,
+                        std::string_view suffix)
+{
+    // The only Reader for the line: the handler and the layout are taken from the same snapshot
+    Settings::Reader settings;
+    auto handler = settings->outputHandler;
+    if (!handler)
+        return;
+
+    Scratch line(lineSlot_t);
+    Settings::formatLine(line.str(), *settings, info, contextName, prefix, body, suffix);
+
+    if (!async::push(handler, info.level, info.kind, line.str()))
+        handler(info.level, info.kind, line.str());
+}
+
+namespace
+{
+
+// Deferred record is: {header}{contextName}{payload of the call site}
+struct DeferredHeader
+{
+    async::RenderFn renderBody;
+    int depth;
+    SentryLogger::Kind kind;
+    SentryLogger::Level level;
+    std::uint32_t contextSize;
+    std::int64_t time;              // 0 if the line layout has no time and thread
+    int threadId;
+    std::string_view threadName;
+};
+
+struct DeferredArgs
+{
+    async::RenderFn renderBody;
+    async::FillFn fill;
+    const void* context;
+    SentryLogger::Kind kind;
+    SentryLogger::Level level;
+    std::string_view contextName;
+    std::int64_t time;
+    int threadId;
+    std::string_view threadName;
+};
+
+void fillDeferred(std::string& buf, const void* context)
+{
+    const auto& args = *static_cast<const DeferredArgs*>(context);
+    DeferredHeader header{args.renderBody,
+                          sentryStack_t.depth,
+                          args.kind,
+                          args.level,
+                          static_cast<std::uint32_t>(args.contextName.size()),
+                          args.time,
+                          args.threadId,
+                          args.threadName};
+    buf.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    buf.append(args.contextName);
+    args.fill(buf, args.context);
+}
+
+}  // namespace
+
+void SentryLogger::renderDeferred(std::string_view payload, std::string& line)
+{
+    DeferredHeader header;
+    std::memcpy(&header, payload.data(), sizeof(header));
+    payload.remove_prefix(sizeof(header));
+    auto contextName = payload.substr(0, header.contextSize);
+    payload.remove_prefix(header.contextSize);
+
+    Scratch body(bodySlot_t);
+    header.renderBody(payload, body.str());
+    line.clear();
+    formatLine(line,
+               {header.depth, header.kind, header.level, ' ', header.time, header.threadId, header.threadName},
+               contextName,
+               "",
+               body.str(),
+               "");
+}
+
+void SentryLogger::printDeferred(async::RenderFn render, async::FillFn fill, const void* context)
+{
+    if ((!enablement_s.isLevelPrinted(logLevel_) && enablement_s.isLevelAllowed(logLevel_)) || tailBuffer_t.owner)
+    {
+        // Flight recorder and tail buffer keep only the ready text
+        Scratch payload(payloadSlot_t);
+        Scratch body(bodySlot_t);
+        fill(payload.str(), context);
+        render(payload.str(), body.str());
+        write(kind_, logLevel_, ' ', getContextName(), "", body.str(), "");
+        return;
+    }
+    triggerRecorder(logLevel_);
+    if (trace::isActive())
+    {
+        // Trace needs the text right now
+        Scratch payload(payloadSlot_t);
+        Scratch body(bodySlot_t);
+        fill(payload.str(), context);
+        render(payload.str(), body.str());
+        trace::instant(body.str(), getContextName());
+    }
+
+    auto handler = Settings::Reader()->outputHandler;
+    if (!handler)
+        return;
+
+    // Time and thread are of this call, not of the writer thread
+    LineInfo origin{};
+    if (lineOriginUsed_s.load(std::memory_order_relaxed))
+        setOrigin(origin);
+    DeferredArgs args{render,
+                      fill,
+                      context,
+                      kind_,
+                      logLevel_,
+                      getContextName(),
+                      origin.time,
+                      origin.threadId,
+                      origin.threadName};
+    if (async::push(handler, logLevel_, kind_, renderDeferred, fillDeferred, &args))
+        return;
 
-    Settings::outputHandler_s(level, kind, s);
+    // Synchronous mode - render immediately
+    Scratch payload(payloadSlot_t);
+    Scratch line(lineSlot_t);
+    fillDeferred(payload.str(), &args);
+    renderDeferred(payload.str(), line.str());
+    handler(logLevel_, kind_, line.str());
 }
 
 
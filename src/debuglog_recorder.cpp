@@ -0,0 +1,303 @@
+/**
+  Purpose: Flight recorder - keep the recent suppressed lines in memory and print them on incident
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+// Always enforce flags with 1 here because we need full class declarations here
+#define DEBUG_LOGGING 1
+
+#include "debuglog_recorder.h"
+#include "debuglog_main.h"
+#include "debuglog_singleton.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <signal.h>
+
+namespace tsv::debuglog::recorder
+{
+
+namespace impl
+{
+std::atomic<bool> requested_s{false};
+}
+
+namespace
+{
+
+constexpr std::size_t kRecordSize = 256;
+constexpr std::size_t kMaxContextSize = 64;
+
+struct Record
+{
+    // 2*idx+1 while the record #idx is written, 2*idx+2 when it is ready (seqlock)
+    std::atomic<std::uint64_t> seq{0};
+    std::int64_t timestamp;         // system clock (ns)
+    sentry_enum::EnumType_t kind;
+    std::uint16_t depth;
+    std::uint16_t contextSize;
+    std::uint16_t textSize;
+    std::uint8_t level;
+    char nestedSym;
+    char text[kRecordSize - 32];   // context name followed by prefix + body + suffix
+};
+static_assert(sizeof(Record) == kRecordSize);
+
+struct Ring
+{
+    explicit Ring(std::size_t size)
+        : records(new Record[size]), capacity(size)
+    {}
+
+    std::unique_ptr<Record[]> records;
+    std::size_t capacity;
+    std::atomic<std::uint64_t> head{0};     // number of written records
+    std::atomic<bool> owned{true};          // used by the live thread
+    std::uint64_t dumped = 0;               // index of the first not dumped record (guarded by Recorder)
+    int threadId = 0;                       // owner thread (guarded by Recorder)
+    std::string_view threadName;
+};
+
+// Copy as much as fits, return number of copied bytes
+std::size_t append(char* dest, std::size_t space, std::string_view str)
+{
+    auto size = std::min(space, str.size());
+    std::memcpy(dest, str.data(), size);
+    return size;
+}
+
+std::int64_t getWallTimestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+class Recorder
+{
+public:
+    static Recorder& get()
+    {
+        return debuglog::impl::leakedSingleton<Recorder>();
+    }
+
+    void configure(const Args& args)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        args_ = args;
+        if (args_.recordsPerThread == 0)
+            args_.recordsPerThread = 1;
+    }
+
+    Args getArgs()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return args_;
+    }
+
+    // Take free ring of the finished thread or create new one
+    Ring* acquire()
+    {
+        SentryLogger::LineInfo origin{};
+        SentryLogger::setOrigin(origin);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Ring* rv = nullptr;
+        for (auto& ring : rings_)
+        {
+            if (!ring->owned.load(std::memory_order_relaxed) && ring->capacity == args_.recordsPerThread)
+            {
+                ring->owned.store(true, std::memory_order_relaxed);
+                rv = ring.get();
+                break;
+            }
+        }
+        if (!rv)
+        {
+            rings_.push_back(std::make_unique<Ring>(args_.recordsPerThread));
+            rv = rings_.back().get();
+        }
+        rv->threadId = origin.threadId;
+        rv->threadName = origin.threadName;
+        return rv;
+    }
+
+    std::size_t dump(std::size_t count)
+    {
+        struct Entry
+        {
+            std::int64_t timestamp;
+            sentry_enum::Kind kind;
+            sentry_enum::Level level;
+            char nestedSym;
+            int depth;
+            int threadId;
+            std::string_view threadName;
+            std::string context;
+            std::string text;
+        };
+        std::vector<Entry> entries;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!count)
+                count = args_.dumpRecords;
+            for (auto& ring : rings_)
+            {
+                auto head = ring->head.load(std::memory_order_acquire);
+                auto from = std::max(ring->dumped, head > ring->capacity ? head - ring->capacity : 0);
+                for (auto idx = from; idx < head; idx++)
+                {
+                    auto& rec = ring->records[idx % ring->capacity];
+                    auto seq = rec.seq.load(std::memory_order_acquire);
+                    if (seq != 2 * idx + 2)
+                        continue;
+                    // Sizes could be of the other record if it is being overwritten, so clamp them
+                    // to stay inside of text[] (the mismatch is rejected by the seq check below)
+                    std::size_t contextSize = std::min<std::size_t>(rec.contextSize, kMaxContextSize);
+                    std::size_t textSize = std::min<std::size_t>(rec.textSize, sizeof(rec.text) - contextSize);
+                    Entry entry{rec.timestamp,
+                                static_cast<sentry_enum::Kind>(rec.kind),
+                                static_cast<sentry_enum::Level>(rec.level),
+                                rec.nestedSym,
+                                rec.depth,
+                                ring->threadId,
+                                ring->threadName,
+                                std::string(rec.text, contextSize),
+                                std::string(rec.text + contextSize, textSize)};
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    // Overwritten while copying
+                    if (rec.seq.load(std::memory_order_relaxed) != seq)
+                        continue;
+                    entries.push_back(std::move(entry));
+                }
+                ring->dumped = head;
+            }
+        }
+        if (entries.empty())
+            return 0;
+
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.timestamp < b.timestamp;
+        });
+        if (entries.size() > count)
+            entries.erase(entries.begin(), entries.end() - static_cast<std::ptrdiff_t>(count));
+
+        SentryLogger::emit({0, sentry_enum::Kind::Default, sentry_enum::Level::Warning, ' '},
+                           "recorder",
+                           "",
+                           "[debuglog] flight recorder: last " + std::to_string(entries.size()) + " records",
+                           "");
+        for (const auto& entry : entries)
+        {
+            SentryLogger::emit(
+                {entry.depth, entry.kind, entry.level, entry.nestedSym, entry.timestamp, entry.threadId, entry.threadName},
+                entry.context,
+                "",
+                entry.text,
+                "");
+        }
+        return entries.size();
+    }
+
+private:
+    std::mutex mutex_;
+    Args args_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+namespace
+{
+
+struct RingHolder
+{
+    ~RingHolder()
+    {
+        if (ring)
+            ring->owned.store(false, std::memory_order_release);
+    }
+    Ring* ring = nullptr;
+};
+
+void onSignal(int /*signo*/)
+{
+    requestDump();
+}
+
+}  // namespace
+
+void configure(const Args& args)
+{
+    Recorder::get().configure(args);
+}
+
+Args getArgs()
+{
+    return Recorder::get().getArgs();
+}
+
+std::size_t dump(std::size_t count /*= 0*/)
+{
+    return Recorder::get().dump(count);
+}
+
+void requestDump()
+{
+    impl::requested_s.store(true, std::memory_order_relaxed);
+}
+
+bool installSignalHandler(int signo)
+{
+    struct sigaction action{};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return ::sigaction(signo, &action, nullptr) == 0;
+}
+
+void impl::capture(sentry_enum::Level level,
+                   sentry_enum::Kind kind,
+                   char nestedSym,
+                   int depth,
+                   std::string_view contextName,
+                   std::string_view prefix,
+                   std::string_view body,
+                   std::string_view suffix)
+{
+    thread_local RingHolder holder_t;
+    if (!holder_t.ring)
+        holder_t.ring = Recorder::get().acquire();
+    auto& ring = *holder_t.ring;
+
+    // Only this thread writes to the ring
+    auto idx = ring.head.load(std::memory_order_relaxed);
+    auto& rec = ring.records[idx % ring.capacity];
+    rec.seq.store(2 * idx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    rec.timestamp = getWallTimestamp();
+    rec.kind = static_cast<sentry_enum::EnumType_t>(kind);
+    rec.level = static_cast<std::uint8_t>(level);
+    rec.nestedSym = nestedSym;
+    rec.depth = static_cast<std::uint16_t>(std::max(depth, 0));
+
+    constexpr std::size_t kTextSize = sizeof(rec.text);
+    std::size_t size = append(rec.text, kMaxContextSize, contextName);
+    rec.contextSize = static_cast<std::uint16_t>(size);
+    size += append(rec.text + size, kTextSize - size, prefix);
+    size += append(rec.text + size, kTextSize - size, body);
+    size += append(rec.text + size, kTextSize - size, suffix);
+    rec.textSize = static_cast<std::uint16_t>(size - rec.contextSize);
+
+    rec.seq.store(2 * idx + 2, std::memory_order_release);
+    ring.head.store(idx + 1, std::memory_order_release);
+}
+
+}  // namespace tsv::debuglog::recorder
@@ -0,0 +1,138 @@
+/**
+  Purpose: Registry of SENTRY_* / SAY_* call sites with runtime per-site switches
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+// Always enforce flags with 1 here because we need full class declarations here
+#define DEBUG_LOGGING 1
+
+#include "debuglog_sites.h"
+#include "debuglog_main.h"
+#include "debuglog_singleton.h"
+
+#include <fnmatch.h>
+#include <mutex>
+
+namespace tsv::debuglog::sites
+{
+
+struct Rule
+{
+    Filter filter;
+    State state;
+};
+
+class Registry
+{
+public:
+    static Registry& get()
+    {
+        return impl::leakedSingleton<Registry>();
+    }
+
+    State add(Site& site, const char* function, sentry_enum::Kind kind)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Other thread could register it while we were waiting
+        auto state = site.state_.load(std::memory_order_relaxed);
+        if (state != State::Unknown)
+            return state;
+        site.function_ = function ? function : "";
+        site.kind_ = kind;
+        site.next_ = head_;
+        head_ = &site;
+        state = evaluateLocked(site);
+        site.state_.store(state, std::memory_order_relaxed);
+        return state;
+    }
+
+    std::size_t set(const Filter& filter, State state)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rules_.push_back({filter, state});
+        std::size_t count = 0;
+        for (auto* site = head_; site; site = site->next_)
+        {
+            if (!matches(filter, *site))
+                continue;
+            site->state_.store(state, std::memory_order_relaxed);
+            count++;
+        }
+        return count;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rules_.clear();
+        for (auto* site = head_; site; site = site->next_)
+            site->state_.store(State::Default, std::memory_order_relaxed);
+    }
+
+    std::vector<SiteInfo> list()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<SiteInfo> rv;
+        for (auto* site = head_; site; site = site->next_)
+            rv.push_back({site->file_,
+                          site->function_,
+                          site->line_,
+                          site->kind_,
+                          site->state_.load(std::memory_order_relaxed)});
+        return rv;
+    }
+
+private:
+    State evaluateLocked(const Site& site) const
+    {
+        State state = State::Default;
+        for (const auto& rule : rules_)
+        {
+            if (matches(rule.filter, site))
+                state = rule.state;
+        }
+        return state;
+    }
+
+    static bool matches(const Filter& filter, const Site& site)
+    {
+        if (site.line_ < filter.firstLine || site.line_ > filter.lastLine)
+            return false;
+        if (::fnmatch(filter.file.c_str(), site.file_, 0) != 0)
+            return false;
+        if (filter.function == "*")
+            return true;
+        std::string function{extractFuncName(site.function_)};
+        return ::fnmatch(filter.function.c_str(), function.c_str(), 0) == 0;
+    }
+
+    std::mutex mutex_;
+    Site* head_ = nullptr;
+    std::vector<Rule> rules_;
+};
+
+State Site::registerSite(const char* function, sentry_enum::Kind kind)
+{
+    return Registry::get().add(*this, function, kind);
+}
+
+std::size_t set(const Filter& filter, State state)
+{
+    if (state == State::Unknown)
+        state = State::Default;
+    return Registry::get().set(filter, state);
+}
+
+void reset()
+{
+    Registry::get().reset();
+}
+
+std::vector<SiteInfo> list()
+{
+    return Registry::get().list();
+}
+
+}  // namespace tsv::debuglog::sites
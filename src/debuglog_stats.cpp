@@ -0,0 +1,414 @@
+/**
+  Purpose: Aggregated timing statistics of sentry scopes
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+// Always enforce flags with 1 here because we need full class declarations here
+#define DEBUG_LOGGING 1
+
+#include "debuglog_stats.h"
+#include "debuglog_settings.h"
+#include "debuglog_singleton.h"
+
+#include "tostr_fmt_include.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace tsv::debuglog::stats
+{
+
+namespace
+{
+
+/**
+ * Log-linear histogram: values below 16 have own bucket, above that each power of 2
+ * is split into 16 buckets. So the relative error of the bucket bound is less than 1/16.
+ */
+constexpr int kSubBits = 4;
+constexpr int kSubBuckets = 1 << kSubBits;
+constexpr int kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+inline int bucketOf(std::uint64_t value)
+{
+    if (value < kSubBuckets)
+        return static_cast<int>(value);
+    int exp = 63 - __builtin_clzll(value);
+    auto sub = static_cast<int>((value >> (exp - kSubBits)) & (kSubBuckets - 1));
+    return (exp - kSubBits + 1) * kSubBuckets + sub;
+}
+
+// The largest value which falls into the bucket
+inline std::uint64_t bucketUpperBound(int idx)
+{
+    if (idx < kSubBuckets)
+        return static_cast<std::uint64_t>(idx);
+    int exp = idx / kSubBuckets + kSubBits - 1;
+    auto sub = static_cast<std::uint64_t>(idx % kSubBuckets);
+    auto lower = (kSubBuckets + sub) << (exp - kSubBits);
+    return lower + (std::uint64_t{1} << (exp - kSubBits)) - 1;
+}
+
+struct Entry
+{
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t min = ~std::uint64_t{0};
+    std::uint64_t max = 0;
+    std::array<std::uint64_t, kBuckets> buckets{};
+
+    void add(std::uint64_t ns)
+    {
+        count++;
+        sum += ns;
+        min = std::min(min, ns);
+        max = std::max(max, ns);
+        buckets[bucketOf(ns)]++;
+    }
+
+    void merge(const Entry& other)
+    {
+        count += other.count;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        for (int i = 0; i < kBuckets; i++)
+            buckets[i] += other.buckets[i];
+    }
+
+    std::uint64_t quantile(double q) const
+    {
+        auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count) + 0.999999);
+        rank = std::clamp<std::uint64_t>(rank, 1, count);
+        std::uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; i++)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+                return std::min(bucketUpperBound(i), max);
+        }
+        return max;
+    }
+};
+
+// Counters of one context updated by the owner thread only. So plain load+store is enough
+// to update them, and atomics just let collect() read a snapshot without locking the owner.
+struct Counters
+{
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> min{~std::uint64_t{0}};
+    std::atomic<std::uint64_t> max{0};
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets{};
+
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    void add(std::uint64_t ns)
+    {
+        bump(buckets[bucketOf(ns)], 1);
+        bump(sum, ns);
+        if (ns < min.load(std::memory_order_relaxed))
+            min.store(ns, std::memory_order_relaxed);
+        if (ns > max.load(std::memory_order_relaxed))
+            max.store(ns, std::memory_order_relaxed);
+        // Published last, so a reader which sees the count sees buckets of these samples too
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Lost updates of the concurrent add() are acceptable here
+    void clear()
+    {
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        min.store(~std::uint64_t{0}, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+        for (auto& bucket : buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    void mergeTo(Entry& target) const
+    {
+        std::uint64_t n = count.load(std::memory_order_acquire);
+        if (!n)
+            return;
+        target.count += n;
+        target.sum += sum.load(std::memory_order_relaxed);
+        target.min = std::min(target.min, min.load(std::memory_order_relaxed));
+        target.max = std::max(target.max, max.load(std::memory_order_relaxed));
+        for (int i = 0; i < kBuckets; i++)
+            target.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Statistics collected by one thread. The owner updates counters without locking,
+ * the mutex is taken only to add a new context while collect() could walk the map.
+ * Counters are never removed (reset() clears them), so pointers of bySite stay valid.
+ */
+struct Shard
+{
+    std::mutex mutex;   // guards structure of byName
+    std::map<std::string, Counters, std::less<>> byName;
+    std::unordered_map<const void*, Counters*> bySite;  // accessed by the owner only
+
+    // Should be called by the owner: it is the only one who modifies byName
+    Counters& get(std::string_view name)
+    {
+        auto it = byName.find(name);
+        if (it == byName.end())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            it = byName.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple())
+                     .first;
+        }
+        return it->second;
+    }
+
+    void mergeToLocked(std::map<std::string, Entry, std::less<>>& target) const
+    {
+        for (auto& [name, counters] : byName)
+        {
+            if (counters.count.load(std::memory_order_relaxed))
+                counters.mergeTo(target[name]);
+        }
+    }
+};
+
+class Registry
+{
+public:
+    Shard& getShard();
+
+    std::map<std::string, Entry, std::less<>> merge()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto result = finished_;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lk(shard->mutex);
+            shard->mergeToLocked(result);
+        }
+        return result;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_.clear();
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lk(shard->mutex);
+            for (auto& [name, counters] : shard->byName)
+                counters.clear();
+        }
+    }
+
+    // Keep statistics of the finished thread, but release its shard
+    void retire(const std::shared_ptr<Shard>& shard)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        {
+            std::lock_guard<std::mutex> lk(shard->mutex);
+            shard->mergeToLocked(finished_);
+        }
+        shards_.erase(std::remove(shards_.begin(), shards_.end(), shard), shards_.end());
+    }
+
+private:
+    std::mutex mutex_;      // guards members below
+    std::vector<std::shared_ptr<Shard>> shards_;
+    std::map<std::string, Entry, std::less<>> finished_;
+};
+
+Registry& getRegistry()
+{
+    return impl::leakedSingleton<Registry>();
+}
+
+struct ShardHolder
+{
+    ~ShardHolder()
+    {
+        if (shard)
+            getRegistry().retire(shard);
+    }
+    std::shared_ptr<Shard> shard;
+};
+
+Shard& Registry::getShard()
+{
+    thread_local ShardHolder holder_t;
+    if (!holder_t.shard)
+    {
+        auto shard = std::make_shared<Shard>();
+        std::lock_guard<std::mutex> lock(mutex_);
+        shards_.push_back(shard);
+        holder_t.shard = std::move(shard);
+    }
+    return *holder_t.shard;
+}
+
+Summary makeSummary(const std::string& name, const Entry& entry)
+{
+    Summary s;
+    s.name = name;
+    s.count = entry.count;
+    s.sum = entry.sum;
+    s.min = entry.count ? entry.min : 0;
+    s.max = entry.max;
+    s.p50 = entry.quantile(0.5);
+    s.p90 = entry.quantile(0.9);
+    s.p99 = entry.quantile(0.99);
+    s.p999 = entry.quantile(0.999);
+    return s;
+}
+
+std::string formatDuration(std::uint64_t ns)
+{
+    if (ns < 1000)
+        return TOSTR_FMT("{}ns", ns);
+    if (ns < 1000000)
+        return TOSTR_FMT("{:.3f}us", static_cast<double>(ns) / 1e3);
+    if (ns < 1000000000)
+        return TOSTR_FMT("{:.3f}ms", static_cast<double>(ns) / 1e6);
+    return TOSTR_FMT("{:.3f}s", static_cast<double>(ns) / 1e9);
+}
+
+std::string escapeLabel(std::string_view value)
+{
+    std::string rv;
+    rv.reserve(value.size());
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+            rv.push_back('\\');
+        if (c == '\n')
+        {
+            rv.append("\\n");
+            continue;
+        }
+        rv.push_back(c);
+    }
+    return rv;
+}
+
+inline double toSeconds(std::uint64_t ns)
+{
+    return static_cast<double>(ns) / 1e9;
+}
+
+}  // namespace
+
+void record(std::string_view name, std::uint64_t ns)
+{
+    getRegistry().getShard().get(name).add(ns);
+}
+
+void recordSite(const void* site, NameFn getName, std::uint64_t ns)
+{
+    auto& shard = getRegistry().getShard();
+    auto it = shard.bySite.find(site);
+    if (it == shard.bySite.end())
+    {
+        // The name is evaluated once per site and thread, it could log something
+        std::string name = getName(site);
+        it = shard.bySite.emplace(site, &shard.get(name)).first;
+    }
+    it->second->add(ns);
+}
+
+std::vector<Summary> collect()
+{
+    std::vector<Summary> rv;
+    for (auto& [name, entry] : getRegistry().merge())
+        rv.push_back(makeSummary(name, entry));
+    return rv;
+}
+
+void dump(sentry_enum::Level level /*= Level::Info*/)
+{
+    auto* root = SentryLogger::getRoot();
+    for (auto& s : collect())
+    {
+        root->write(SentryLogger::Kind::Default,
+                    level,
+                    ' ',
+                    "stats",
+                    "",
+                    TOSTR_FMT("{}: count={} avg={} min={} p50={} p90={} p99={} p999={} max={}",
+                              s.name,
+                              s.count,
+                              formatDuration(s.count ? s.sum / s.count : 0),
+                              formatDuration(s.min),
+                              formatDuration(s.p50),
+                              formatDuration(s.p90),
+                              formatDuration(s.p99),
+                              formatDuration(s.p999),
+                              formatDuration(s.max)),
+                    "");
+    }
+}
+
+bool writeOpenMetrics(const std::string& path)
+{
+    auto summaries = collect();
+
+    std::string out;
+    out += "# TYPE debuglog_scope_duration_seconds summary\n"
+           "# UNIT debuglog_scope_duration_seconds seconds\n"
+           "# HELP debuglog_scope_duration_seconds Duration of sentry scopes.\n";
+    for (auto& s : summaries)
+    {
+        auto label = escapeLabel(s.name);
+        const std::pair<const char*, std::uint64_t> quantiles[] = {
+            {"0.5", s.p50}, {"0.9", s.p90}, {"0.99", s.p99}, {"0.999", s.p999}};
+        for (auto& [q, value] : quantiles)
+            out += TOSTR_FMT("debuglog_scope_duration_seconds{{context=\"{}\",quantile=\"{}\"}} {}\n",
+                             label, q, toSeconds(value));
+        out += TOSTR_FMT("debuglog_scope_duration_seconds_sum{{context=\"{}\"}} {}\n", label, toSeconds(s.sum));
+        out += TOSTR_FMT("debuglog_scope_duration_seconds_count{{context=\"{}\"}} {}\n", label, s.count);
+    }
+    const std::pair<const char*, std::uint64_t Summary::*> bounds[] = {{"min", &Summary::min},
+                                                                       {"max", &Summary::max}};
+    for (auto& [bound, field] : bounds)
+    {
+        out += TOSTR_FMT("# TYPE debuglog_scope_duration_{0}_seconds gauge\n"
+                         "# UNIT debuglog_scope_duration_{0}_seconds seconds\n",
+                         bound);
+        for (auto& s : summaries)
+            out += TOSTR_FMT("debuglog_scope_duration_{}_seconds{{context=\"{}\"}} {}\n",
+                             bound, escapeLabel(s.name), toSeconds(s.*field));
+    }
+    out += "# EOF\n";
+
+    // Scraper should never see half-written file
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file)
+            return false;
+    }
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+void reset()
+{
+    getRegistry().reset();
+}
+
+}  // namespace tsv::debuglog::stats
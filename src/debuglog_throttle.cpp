@@ -0,0 +1,97 @@
+/**
+  Purpose: Per-call-site throttling of SAY_*_THROTTLED / SENTRY_*_THROTTLED
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+// Always enforce flags with 1 here because we need full class declarations here
+#define DEBUG_LOGGING 1
+
+#include "debuglog_throttle.h"
+#include "debuglog_main.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+
+namespace tsv::debuglog::throttle
+{
+
+namespace
+{
+
+// Push-only list of the sites which have suppressed something
+std::atomic<Site*> sites_s{nullptr};
+
+std::uint64_t getCurTimestamp()
+{
+    using namespace std::chrono;
+    return static_cast<std::uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace
+
+bool Site::allowRate()
+{
+    // Generic cell rate algorithm: each passed call moves theoretical arrival time by the interval.
+    // Call passes if that time is not too far in the future (up to N calls at once).
+    constexpr std::uint64_t kSecond = 1000000000;
+    const std::uint64_t interval = std::max<std::uint64_t>(kSecond / spec_.n, 1);
+    const std::uint64_t tolerance = kSecond - interval;
+
+    auto now = getCurTimestamp();
+    auto tat = counter_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto base = std::max(tat, now);
+        if (base - now > tolerance)
+            return false;
+        if (counter_.compare_exchange_weak(tat, base + interval, std::memory_order_relaxed))
+            return true;
+    }
+}
+
+void Site::suppress()
+{
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    if (registered_.load(std::memory_order_relaxed) || registered_.exchange(true, std::memory_order_relaxed))
+        return;
+    next_ = sites_s.load(std::memory_order_relaxed);
+    while (!sites_s.compare_exchange_weak(next_, this, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::string Site::summary(std::uint64_t count)
+{
+    return "[debuglog] " + std::to_string(count) + " messages suppressed";
+}
+
+std::string Site::getLocation() const
+{
+    std::string_view file{file_};
+    auto pos = file.rfind('/');
+    if (pos != std::string_view::npos)
+        file.remove_prefix(pos + 1);
+    return std::string(file) + ":" + std::to_string(line_);
+}
+
+void dumpSuppressed(sentry_enum::Level level /*= Level::Warning*/)
+{
+    auto* root = SentryLogger::getRoot();
+    for (auto* site = sites_s.load(std::memory_order_acquire); site; site = site->getNext())
+    {
+        auto count = site->takeSuppressed();
+        if (count)
+            root->write(SentryLogger::Kind::Default,
+                        level,
+                        ' ',
+                        "throttle",
+                        "",
+                        "[debuglog] " + std::to_string(count) + " messages suppressed at " + site->getLocation(),
+                        "");
+    }
+}
+
+}  // namespace tsv::debuglog::throttle
@@ -0,0 +1,258 @@
+/**
+  Purpose: Export of sentries as Chrome Trace Event Format (chrome://tracing, Perfetto)
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+#include "debuglog_trace.h"
+
+#include "tostr_fmt_include.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tsv::debuglog::trace
+{
+
+namespace impl
+{
+std::atomic<bool> active_s{false};
+}
+
+namespace
+{
+
+struct ThreadBuffer
+{
+    std::mutex mutex;       // contended only during flush()/stop()
+    std::string data;
+    std::uint64_t generation = 0;
+    int tid = 0;
+};
+
+// Append string as JSON string literal
+void appendJson(std::string& out, std::string_view str)
+{
+    out.push_back('"');
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    out.append(TOSTR_FMT("\\u{:04x}", static_cast<int>(c)));
+                else
+                    out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+// Trace timestamps are in microseconds
+void appendMicros(std::string& out, std::int64_t ns)
+{
+    if (ns < 0)
+        ns = 0;
+    out.append(TOSTR_FMT("{}.{:03}", ns / 1000, ns % 1000));
+}
+
+class Tracer
+{
+public:
+    ~Tracer() { stop(); }
+
+    bool start(const std::string& path, const Args& args)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_)
+            return false;
+        file_ = std::fopen(path.c_str(), "w");
+        if (!file_)
+            return false;
+        std::fputs("{\"traceEvents\":[\n", file_);
+        args_ = args;
+        origin_ = now();
+        pid_ = static_cast<int>(::getpid());
+        buffers_.clear();
+        generation_.fetch_add(1, std::memory_order_relaxed);
+        impl::active_s.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_)
+            return;
+        impl::active_s.store(false, std::memory_order_release);
+        writeBuffersLocked();
+
+        // The last event has no trailing comma
+        std::string tail;
+        tail.append(TOSTR_FMT("{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},\"args\":{{\"name\":\"debuglog\"}}}}\n",
+                              pid_));
+        tail.append("],\"displayTimeUnit\":\"ns\"}\n");
+        std::fputs(tail.c_str(), file_);
+        std::fclose(file_);
+        file_ = nullptr;
+        buffers_.clear();
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_)
+            return;
+        writeBuffersLocked();
+        std::fflush(file_);
+    }
+
+    // fn(std::string& out, std::int64_t origin, int pid, int tid) appends the event
+    template <typename Fn>
+    void append(Fn&& fn)
+    {
+        auto& buffer = getBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        // Checked under the lock, so stop() never misses the event
+        if (!isActive())
+            return;
+        fn(buffer.data, origin_, pid_, buffer.tid);
+        buffer.data.append(",\n");
+        if (buffer.data.size() >= args_.chunkSize)
+            writeChunk(buffer);
+    }
+
+private:
+    ThreadBuffer& getBuffer();
+
+    // Should be called under the lock of the buffer
+    void writeChunk(ThreadBuffer& buffer)
+    {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        if (file_)
+            std::fwrite(buffer.data.data(), 1, buffer.data.size(), file_);
+        buffer.data.clear();
+    }
+
+    void writeBuffersLocked()
+    {
+        for (auto& buffer : buffers_)
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            writeChunk(*buffer);
+        }
+    }
+
+    std::mutex mutex_;          // guards start/stop and the list of buffers
+    std::mutex fileMutex_;      // guards writing to the file
+    std::FILE* file_ = nullptr;
+    Args args_;
+    std::int64_t origin_ = 0;
+    int pid_ = 0;
+    std::atomic<std::uint64_t> generation_{0};
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+Tracer& getTracer()
+{
+    // Destructor of this static closes the trace at exit
+    static Tracer tracer;
+    return tracer;
+}
+
+ThreadBuffer& Tracer::getBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer_t;
+    auto generation = generation_.load(std::memory_order_relaxed);
+    if (!buffer_t || buffer_t->generation != generation)
+    {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->generation = generation;
+        buffer->tid = static_cast<int>(::syscall(SYS_gettid));
+        buffer->data.reserve(args_.chunkSize + 1024);
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers_.push_back(buffer);
+        buffer_t = std::move(buffer);
+    }
+    return *buffer_t;
+}
+
+}  // namespace
+
+bool start(const std::string& path, Args args /*= {}*/)
+{
+    return getTracer().start(path, args);
+}
+
+void stop()
+{
+    getTracer().stop();
+}
+
+void flush()
+{
+    getTracer().flush();
+}
+
+std::int64_t now()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void complete(std::string_view name,
+              std::int64_t startNs,
+              std::int64_t finishNs,
+              std::string_view enterArgs,
+              std::string_view returnValue)
+{
+    getTracer().append([&](std::string& out, std::int64_t origin, int pid, int tid) {
+        // Scope which is started before the trace is cut to the beginning of the trace
+        startNs = std::max(startNs, origin);
+        out.append("{\"name\":");
+        appendJson(out, name);
+        out.append(",\"cat\":\"sentry\",\"ph\":\"X\",\"ts\":");
+        appendMicros(out, startNs - origin);
+        out.append(",\"dur\":");
+        appendMicros(out, finishNs - startNs);
+        out.append(TOSTR_FMT(",\"pid\":{},\"tid\":{},\"args\":{{", pid, tid));
+        if (!enterArgs.empty())
+        {
+            out.append("\"enter\":");
+            appendJson(out, enterArgs);
+        }
+        if (!returnValue.empty())
+        {
+            out.append(enterArgs.empty() ? "\"rv\":" : ",\"rv\":");
+            appendJson(out, returnValue);
+        }
+        out.append("}}");
+    });
+}
+
+void instant(std::string_view body, std::string_view context)
+{
+    auto ts = now();
+    getTracer().append([&](std::string& out, std::int64_t origin, int pid, int tid) {
+        out.append("{\"name\":");
+        appendJson(out, body);
+        out.append(",\"cat\":\"say\",\"ph\":\"i\",\"s\":\"t\",\"ts\":");
+        appendMicros(out, ts - origin);
+        out.append(TOSTR_FMT(",\"pid\":{},\"tid\":{},\"args\":{{\"context\":", pid, tid));
+        appendJson(out, context);
+        out.append("}}");
+    });
+}
+
+}  // namespace tsv::debuglog::trace
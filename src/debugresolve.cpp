@@ -19,14 +19,24 @@
 
 #include "tostr_fmt_include.h"
 #include "debugresolve.h"
+#include "debugsymbols.h"
+#include "debugsymcache.h"
+#include "debuglog_intern.h"
+#include "debuglog_singleton.h"
 #include "tostr.h"      // for ::tsv::util::tostr::hex_addr and TOSTR_FMT
 //#include "debuglog.h"
 
 #include <string>
 #include <mutex>
+#include <shared_mutex>
+#include <future>
+#include <chrono>
 #include <cstdlib>
+#include <cstdint>
 #include <cstring>      //strlen
 #include <memory>
+#include <algorithm>
+#include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <unistd.h>
@@ -46,6 +56,9 @@
 
 #if BACKTRACE_USE_ADDR2LINE
 #include <signal.h>     // kill()
+#include <poll.h>
+#include <fcntl.h>
+#include <cerrno>
 #endif
 
 #if defined(__GNUG__) || defined(__clang__)
@@ -85,12 +98,19 @@ namespace resolve::settings
     bool btShortList = true;       // if true, remember already printed stacktraces and just say it's number on repeat
     bool btShortListOnly = false;  // if true, do not print full stack - only short line
     int  btNumHeadFuncs = 4;       // how many first functions include into collapsed stacktrace
+    bool btUseSymbolizer = true;   // if true, resolve function names and lines by in-process symbolizer (see debugsymbols.h)
+    int  btResolverWorkers = 4;    // max number of addr2line processes which resolve addresses in parallel
+    bool btPersistentCache = false; // if true, keep answers of addr2line on disk between runs (see debugsymcache.h)
+    std::string btCacheDir;        // directory of persistent cache (if empty - $XDG_CACHE_HOME/debuglog)
     BTDisabledOutputFunc_t btDisabledOutputCallback = nullptr; // Called by getStackTrace() in case if btEnable=false
 }
 
-#if defined(__GNUG__) || defined(__clang)
-std::string demangle(const char* name) {
+namespace
+{
 
+#if defined(__GNUG__) || defined(__clang__)
+std::string demangleUncached(const char* name)
+{
     int status = -4; // some arbitrary value to eliminate the compiler warning
 
     std::unique_ptr<char, void(*)(void*)> res {
@@ -100,26 +120,102 @@ std::string demangle(const char* name) {
 
     return (status==0) ? res.get() : name ;
 }
-
 #else
-
 // does nothing if not g++
-std::string demangle(const char* name) {
+std::string demangleUncached(const char* name)
+{
     return name;
 }
 #endif
 
+/**
+ * Append-only map of mangled names to demangled ones (both interned). Lookup is first done in the small per-thread
+ * direct-mapped cache (names given by typeid() are static, so usually pointer matches),
+ * the global table is locked only on its miss.
+ */
+class DemangleCache
+{
+public:
+    static DemangleCache& get()
+    {
+        return impl::leakedSingleton<DemangleCache>();
+    }
+
+    const std::string& demangle(const char* name)
+    {
+        struct Entry
+        {
+            const char* name = nullptr;
+            const std::string* mangled = nullptr;
+            const std::string* demangled = nullptr;
+        };
+        thread_local Entry cache_t[kCacheSize]{};
+
+        auto& entry = cache_t[(reinterpret_cast<std::uintptr_t>(name) >> 3) % kCacheSize];
+        if (entry.name == name && *entry.mangled == name)
+            return *entry.demangled;
+
+        std::string_view key = name;
+        const std::string* mangled = nullptr;
+        const std::string* demangled = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = names_.find(key);
+            if (it != names_.end())
+            {
+                mangled = it->second.first;
+                demangled = it->second.second;
+            }
+        }
+        if (!demangled)
+        {
+            // Demangle without lock - it is the slow part
+            auto value = demangleUncached(name);
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = names_.find(key);
+            if (it != names_.end())
+            {
+                mangled = it->second.first;
+                demangled = it->second.second;
+            }
+            else
+            {
+                mangled = &internString(key);
+                demangled = &internString(value);
+                names_.emplace(*mangled, std::make_pair(mangled, demangled));
+            }
+        }
+        entry = {name, mangled, demangled};
+        return *demangled;
+    }
+
+private:
+    static constexpr std::size_t kCacheSize = 64;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string_view, std::pair<const std::string*, const std::string*>> names_;   // by mangled
+};
+
+}  // namespace
+
+const std::string& demangle(const char* name)
+{
+    return DemangleCache::get().demangle(name);
+}
+
 /***************** BEGIN OF local aux functions *******************************/
 
 
 namespace {
 namespace symbol_resolve {
 
-/***************************************************************************
-     Symbol resolving ( call external utility addr2line and parse output )
-***************************************************************************/
-
-#if BACKTRACE_USE_ADDR2LINE
+struct SymbolEntry
+{
+    std::string funcName_;
+    std::string pathName_;
+    std::string getFuncAndLine() { return funcName_ + pathName_; }
+    std::string getSymbol( bool includeLine ) { return includeLine ? (funcName_ + pathName_) : funcName_; }
+};
 
 // PURPOSE: split string "s" to vector "elems" by delimiter "delim"
 int ssplit( const std::string &s, char delim, std::vector<std::string> &elems )
@@ -157,6 +253,12 @@ std::string squeezePath( const std::string& path )
     return result;
 }
 
+/***************************************************************************
+     Symbol resolving ( call external utility addr2line and parse output )
+***************************************************************************/
+
+#if BACKTRACE_USE_ADDR2LINE
+
 /***************************************************************************
         Auxilary class which actually run child "addr2line" and
             communicate with it to resolve address
@@ -164,12 +266,11 @@ std::string squeezePath( const std::string& path )
 class Addr2LineResolver
 {
    public:
-        Addr2LineResolver()
+        // Executable or shared object which addresses are resolved
+        explicit Addr2LineResolver( std::string module )
+            : module_( std::move( module ) )
         {
            child_pid_ = 0;
-           // cleanup other session
-           if ( system("killall -9 " ADDR2LINE_PATH " 2>/dev/null") < 0 )
-                perror("Fail to killall:");
         }
 
         ~Addr2LineResolver()
@@ -186,15 +287,11 @@ class Addr2LineResolver
         }
 
 
-        struct CacheEntry
-        {
-            std::string funcName_;
-            std::string pathName_;
-            std::string getFuncAndLine() { return funcName_ + pathName_; }
-            std::string getSymbol( bool includeLine ) { return includeLine ? (funcName_ + pathName_) : funcName_; }
-        };
+        using CacheEntry = SymbolEntry;
 
-        CacheEntry request(const void* addr);
+        // Ask about all addresses (relative to the load base of module) at once.
+        // Return false if child failed (entries are filled partially).
+        bool resolve( const std::vector<const void*>& addrs, std::vector<CacheEntry>& entries );
 
         static bool isStopWord( const std::string& funcName )
         {
@@ -204,104 +301,123 @@ class Addr2LineResolver
         }
 
    private:
-        std::unordered_map<const void*, CacheEntry> addrCache_;
-        char  buf_[512];
+        // Addresses per one write. Their answers are read before the next write,
+        // so the child never blocks on a full output pipe while we are writing.
+        static constexpr int kMaxBatch = 128;
+        static constexpr int kReplyTimeoutMs = 3000;    // how long wait for the answer of child
+        static constexpr std::size_t kMaxLine = 500;     // longer answers are truncated
+
+        std::string module_;
+        std::string request_;   // batch of addresses to send
+        char  rbuf_[65536];     // buffered answers of child
+        std::size_t rpos_ = 0, rlen_ = 0;
         pid_t child_pid_;       // 0=do not exists yet, <0=failed
         int   pipefd_[2];       // [0]=to say child, [1]=listen child
 
    private:
-        static pid_t popen2( const char *command, int *infp, int *outfp );
-        void pipe_say();
-        void pipe_getline();
+        static pid_t popen2( const char *module, int *infp, int *outfp );
+        bool start();
+        void pipe_say( const std::string& msg );
+        bool pipe_getline( std::string& line );
         static bool checkstopwords();
 
 };
 
-// Main method: ask child and parse answer about name/line
-Addr2LineResolver::CacheEntry Addr2LineResolver::request(const void* addr )
+// Run addr2line on the first request. Return false if it is not running.
+bool Addr2LineResolver::start()
 {
-    // Protection check
-    if ( !addr )
-        return { "nullptr", "" };
-
-    auto it = addrCache_.find( addr );
-    if ( it != addrCache_.end() )
-         return it->second;
-
     if ( child_pid_ == 0 )
     {
-        int n = snprintf(buf_, sizeof(buf_), ADDR2LINE_PATH " -f -C -e `readlink /proc/%d/exe`", getpid() );
-        if (static_cast<std::size_t>(n+1) >= sizeof(buf_))
+        child_pid_ = popen2( module_.c_str(), &pipefd_[0], &pipefd_[1] );
+        if ( child_pid_ <= 0)
         {
-            //SAY_DBG( "Unable to run addr2line - command buffer overflow" );
+            //SAY_DBG( "Unable to exec: rv=%d\n", child_pid_ );
             child_pid_=-1;
         }
-        else
-        {
-            child_pid_ = popen2( buf_, &pipefd_[0], &pipefd_[1] );
-            if ( child_pid_ <= 0)
-            {
-                //SAY_DBG( "Unable to exec: rv=%d\n", child_pid_ );
-                child_pid_=-1;
-            }
-        }
     }
-    if (child_pid_ <= 0)
-         return { "{no info}", "" };
-
-    sprintf(buf_, "%p\n", addr);
-    pipe_say();
-
-    pipe_getline();
-    std::string funcName( buf_ );
+    return child_pid_ > 0;
+}
 
-    pipe_getline();
+// Main method: send addresses by one write per batch, then read all answers (two lines per address)
+bool Addr2LineResolver::resolve( const std::vector<const void*>& addrs, std::vector<CacheEntry>& entries )
+{
+    entries.clear();
+    if ( !start() )
+        return false;
 
-    std::string path;
-    if ( path.find( "??:" ) != 0 )
+    std::string funcName, path;
+    for ( std::size_t from = 0; from < addrs.size(); from += kMaxBatch )
     {
-        path =  buf_ ;
+        std::size_t to = std::min( addrs.size(), from + kMaxBatch );
+        request_.clear();
+        char addrBuf[32];
+        for ( std::size_t i = from; i < to; i++ )
+        {
+            snprintf( addrBuf, sizeof(addrBuf), "%p\n", addrs[i] );
+            request_.append( addrBuf );
+        }
+        pipe_say( request_ );
 
-        if ( path.find( "/.." ) != std::string::npos )
-            path = squeezePath( path );
+        for ( std::size_t i = from; i < to; i++ )
+        {
+            if ( !pipe_getline( funcName ) || !pipe_getline( path ) )
+                return false;
 
-        static const std::string at_str(" at ");
-        path =  at_str + path;
+            // "??:0" or "??:?" if line is unknown
+            if ( path.compare( 0, 3, "??:" ) == 0 )
+                path.clear();
+            else
+            {
+                if ( path.find( "/.." ) != std::string::npos )
+                    path = squeezePath( path );
+                path.insert( 0, " at " );
+            }
+            entries.push_back( CacheEntry{ funcName, path } );
+        }
     }
-
-    CacheEntry entry { funcName, path };
-
-    addrCache_[addr] = entry;
-    return entry;
+    return true;
 }
 
-// Run command and bind with pipes to descriptors *infp/*outfp
-pid_t Addr2LineResolver::popen2( const char *command, int *infp, int *outfp )
+// Run addr2line for the module and bind with pipes to descriptors *infp/*outfp
+pid_t Addr2LineResolver::popen2( const char *module, int *infp, int *outfp )
 {
     int p_stdin[2], p_stdout[2];
     pid_t pid;
 
     enum {PIPEREAD=0, PIPEWRITE=1};
 
-    if (pipe(p_stdin) != 0 || pipe(p_stdout) != 0)
+    // Pipes of other children shouldn't be inherited (otherwise they never see EOF)
+    if (pipe2(p_stdin, O_CLOEXEC) != 0)
         return -1;
+    if (pipe2(p_stdout, O_CLOEXEC) != 0)
+    {
+        close(p_stdin[PIPEREAD]);
+        close(p_stdin[PIPEWRITE]);
+        return -1;
+    }
 
     pid = fork();
 
     if (pid < 0)
+    {
+        for (int fd : { p_stdin[0], p_stdin[1], p_stdout[0], p_stdout[1] })
+            close(fd);
         return pid;
+    }
     else if (pid == 0)
     {
-        close(p_stdin[PIPEWRITE]);
+        // dup2() clears close-on-exec flag of the new descriptor
         dup2(p_stdin[PIPEREAD], PIPEREAD);
-        close(p_stdout[PIPEREAD]);
         dup2(p_stdout[PIPEWRITE], PIPEWRITE);
 
-        execl("/bin/sh", "sh", "-c", command, nullptr );
+        execl(ADDR2LINE_PATH, "addr2line", "-f", "-C", "-e", module, nullptr );
         perror("execl");
-        exit(1);
+        _exit(1);
     }
 
+    close(p_stdin[PIPEREAD]);
+    close(p_stdout[PIPEWRITE]);
+
     if ( infp == nullptr )
         close(p_stdin[PIPEWRITE]);
     else
@@ -315,59 +431,376 @@ pid_t Addr2LineResolver::popen2( const char *command, int *infp, int *outfp )
     return pid;
 }
 
-// send string buf_ to child
-void Addr2LineResolver::pipe_say()
+// send string to child
+void Addr2LineResolver::pipe_say( const std::string& msg )
 {
-        if ( child_pid_ <= 0 )
-                return;
-        int ln = write( pipefd_[0], buf_, strlen( buf_ ) ); // write message to the process
-        if ( ln < 1 )
+        std::size_t done = 0;
+        while ( child_pid_ > 0 && done < msg.size() )
         {
-            perror("Fail to pipe write:");
-            child_pid_ = -child_pid_;
+            auto ln = write( pipefd_[0], msg.data() + done, msg.size() - done ); // write message to the process
+            if ( ln < 0 && errno == EINTR )
+                continue;
+            if ( ln < 1 )
+            {
+                perror("Fail to pipe write:");
+                child_pid_ = -child_pid_;
+                return;
+            }
+            done += static_cast<std::size_t>( ln );
         }
-
 }
 
-// get string from child to buf_ (and cut off terminal \n )
-void Addr2LineResolver::pipe_getline()
+// get line from child (without terminal \n). Return false if child failed or doesn't answer.
+bool Addr2LineResolver::pipe_getline( std::string& line )
 {
-        buf_[0] = 0;
-        if ( child_pid_ <= 0 )
-                return;
-
-        std::size_t idx = 0;
-        char ch;
-        int len;
+        line.clear();
         for(;;)
         {
-            len = read( pipefd_[1], &ch, 1 );
+            if ( child_pid_ <= 0 )
+                return false;
+
+            if ( rpos_ < rlen_ )
+            {
+                const char* begin = rbuf_ + rpos_;
+                const char* eol = static_cast<const char*>( memchr( begin, '\n', rlen_ - rpos_ ) );
+                std::size_t len = eol ? static_cast<std::size_t>( eol - begin ) : rlen_ - rpos_;
+                if ( line.size() < kMaxLine )
+                    line.append( begin, std::min( len, kMaxLine - line.size() ) );
+                rpos_ += len + ( eol ? 1 : 0 );
+                if ( eol )
+                    return true;
+            }
+
+            // Buffer is consumed - wait for the next portion of answers
+            pollfd pfd{ pipefd_[1], POLLIN, 0 };
+            int ready = poll( &pfd, 1, kReplyTimeoutMs );
+            if ( ready < 0 && errno == EINTR )
+                continue;
+            auto len = ready > 0 ? read( pipefd_[1], rbuf_, sizeof(rbuf_) ) : -1;
+            if ( len < 0 && errno == EINTR )
+                continue;
             if ( len < 1 )
             {
                 child_pid_ = -child_pid_;
-                buf_[idx] = 0;
-                perror("fail read pipe");
-                return;
+                if ( ready == 0 )
+                    fprintf( stderr, "addr2line doesn't answer\n" );
+                else
+                    perror("fail read pipe");
+                return false;
             }
+            rpos_ = 0;
+            rlen_ = static_cast<std::size_t>( len );
+        }
+}
+
+#endif // BACKTRACE_USE_ADDR2LINE
 
-            if ( ch == '\n' )
+// Resolve by in-process symbolizer: function name from the symbol tables, file and line from DWARF.
+// Doesn't need the lock. Return false if something is unknown there.
+bool resolveBySymbolizer(const void* addr, bool needLine, SymbolEntry& entry)
+{
+    if ( !addr || !resolve::settings::btUseSymbolizer )
+        return false;
+    auto funcName = symbols::functionName( addr );
+    if ( funcName.empty() )
+        return false;
+
+    std::string path;
+    if ( needLine )
+    {
+        std::string_view file;
+        int line = 0;
+        if ( !symbols::lookupLine( addr, file, line ) )
+            return false;
+        path.assign( file );
+        if ( !path.empty() && path[0] == '/' && path.find( "/.." ) != std::string::npos )
+            path = squeezePath( path );
+        path = " at " + path + ":" + std::to_string( line );
+    }
+    entry = { std::string( funcName ), std::move( path ) };
+    return true;
+}
+
+// Answers of the previous runs (see debugsymcache.h). The entry without path is good only if no line needed.
+bool resolveByCache(const void* addr, bool needLine, SymbolEntry& entry)
+{
+    if ( !addr || !resolve::settings::btPersistentCache )
+        return false;
+    return symcache::find( addr, entry.funcName_, entry.pathName_ ) && ( !needLine || !entry.pathName_.empty() );
+}
+
+// Resolve without addr2line: by the persistent cache, then by symbolizer (its answers are cached too)
+bool resolveLocally(const void* addr, bool needLine, SymbolEntry& entry)
+{
+    if ( resolveByCache( addr, needLine, entry ) )
+        return true;
+    if ( !resolveBySymbolizer( addr, needLine, entry ) )
+        return false;
+    if ( resolve::settings::btPersistentCache )
+    {
+        symcache::store( addr, entry.funcName_, entry.pathName_ );
+        symcache::flushPeriodically();
+    }
+    return true;
+}
+
+#if BACKTRACE_USE_ADDR2LINE
+/***************************************************************************
+        Pool of addr2line children with the shared cache of answers.
+
+  Cache is split into shards by address, so readers take only shared lock of
+  one shard. The first thread which misses the address marks it as in flight
+  and resolves it, others wait for its answer instead of asking again.
+  Each worker (child process) has its own lock, so independent addresses are
+  resolved in parallel. Extra children are started only if all others are busy.
+***************************************************************************/
+class ResolverPool
+{
+   public:
+        using Entry = SymbolEntry;
+
+        static ResolverPool& get()
+        {
+            static ResolverPool pool( resolve::settings::btResolverWorkers );
+            return pool;
+        }
+
+        explicit ResolverPool( int workers )
+            : workers_( static_cast<std::size_t>( std::max( workers, 1 ) ) )
+        {
+            for ( auto& worker : workers_ )
+                worker = std::make_unique<Worker>();
+        }
+
+        Entry request( const void* addr )
+        {
+            if ( !addr )
+                return { "nullptr", "" };
+            Entry entry;
+            if ( !find( addr, entry ) )
             {
-                buf_[idx] = 0;
-                return;
+                prefetch( &addr, 1 );
+                if ( !find( addr, entry ) )
+                    return { "{no info}", "" };
             }
-            if ( idx > ( sizeof(buf_) - 5 ) )
+            return entry;
+        }
+
+        // Resolve all uncached addresses (by one request per worker)
+        void prefetch( const void* const* addrs, int count );
+
+   private:
+        static constexpr std::size_t kShards = 16;
+
+        struct Shard
+        {
+            std::shared_mutex mutex;
+            std::unordered_map<const void*, Entry> cache;
+            std::unordered_map<const void*, std::shared_future<void>> inFlight;
+        };
+
+        struct Worker
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::unique_ptr<Addr2LineResolver>> resolvers;   // by module
+
+            Addr2LineResolver& resolverOf( const std::string& module )
+            {
+                auto& resolver = resolvers[module];
+                if ( !resolver )
+                    resolver = std::make_unique<Addr2LineResolver>( module );
+                return *resolver;
+            }
+        };
+
+        static void resolve( Worker& worker, const std::vector<const void*>& addrs,
+                             std::vector<Entry>& entries, std::vector<bool>& resolved );
+
+        Shard& shardOf( const void* addr )
+        {
+            // Code addresses are aligned, so skip low bits
+            return shards_[ ( reinterpret_cast<std::uintptr_t>( addr ) >> 4 ) % kShards ];
+        }
+
+        bool find( const void* addr, Entry& entry )
+        {
+            auto& shard = shardOf( addr );
+            std::shared_lock<std::shared_mutex> lock( shard.mutex );
+            auto it = shard.cache.find( addr );
+            if ( it == shard.cache.end() )
+                return false;
+            entry = it->second;
+            return true;
+        }
+
+        // Lock the first free worker, or wait for the first one if all are busy
+        std::unique_lock<std::mutex> lockWorker( Worker*& worker )
+        {
+            for ( auto& candidate : workers_ )
+            {
+                std::unique_lock<std::mutex> lock( candidate->mutex, std::try_to_lock );
+                if ( lock.owns_lock() )
+                {
+                    worker = candidate.get();
+                    return lock;
+                }
+            }
+            worker = workers_.front().get();
+            return std::unique_lock<std::mutex>( worker->mutex );
+        }
+
+        Shard shards_[kShards];
+        std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+void ResolverPool::prefetch( const void* const* addrs, int count )
+{
+    std::vector<const void*> mine;                   // addresses to resolve by this thread
+    std::vector<std::shared_future<void>> others;    // addresses resolved by other threads
+    std::promise<void> done;
+    auto doneFuture = done.get_future().share();
+    for ( int i = 0; i < count; i++ )
+    {
+        const void* addr = addrs[i];
+        if ( !addr )
+            continue;
+        auto& shard = shardOf( addr );
+        {
+            std::shared_lock<std::shared_mutex> lock( shard.mutex );
+            if ( shard.cache.count( addr ) )
                 continue;
-            buf_[idx++] = ch;
         }
+        std::unique_lock<std::shared_mutex> lock( shard.mutex );
+        if ( shard.cache.count( addr ) )
+            continue;
+        auto [it, inserted] = shard.inFlight.emplace( addr, doneFuture );
+        if ( inserted )
+            mine.push_back( addr );
+        else if ( it->second.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+            others.push_back( it->second );
+    }
+
+    if ( !mine.empty() )
+    {
+        // The persistent cache was already asked by resolveLocally()
+        std::vector<Entry> entries( mine.size() );
+        std::vector<bool> resolved( mine.size() );
+        {
+            Worker* worker = nullptr;
+            auto lock = lockWorker( worker );
+            resolve( *worker, mine, entries, resolved );
+        }
+        if ( resolve::settings::btPersistentCache )
+        {
+            // Unknown addresses could become known in other build, so only good answers are kept
+            for ( std::size_t i = 0; i < mine.size(); i++ )
+            {
+                if ( resolved[i] && entries[i].funcName_ != "?\?" )
+                    symcache::store( mine[i], entries[i].funcName_, entries[i].pathName_ );
+            }
+            symcache::flushPeriodically();
+        }
+
+        // Unresolved (child failed) are not cached
+        for ( std::size_t i = 0; i < mine.size(); i++ )
+        {
+            auto& shard = shardOf( mine[i] );
+            std::unique_lock<std::shared_mutex> lock( shard.mutex );
+            if ( resolved[i] )
+                shard.cache.emplace( mine[i], std::move( entries[i] ) );
+            shard.inFlight.erase( mine[i] );
+        }
+        done.set_value();
+    }
+
+    for ( auto& future : others )
+        future.wait();
+}
+
+// Group addresses by module and ask addr2line of each module about offsets inside it
+void ResolverPool::resolve( Worker& worker, const std::vector<const void*>& addrs,
+                            std::vector<Entry>& entries, std::vector<bool>& resolved )
+{
+    struct Group
+    {
+        std::vector<const void*> offsets;
+        std::vector<std::size_t> idx;
+    };
+    std::unordered_map<std::string, Group> groups;
+    for ( std::size_t i = 0; i < addrs.size(); i++ )
+    {
+        symbols::Module module;
+        std::string path;
+        const void* offset = addrs[i];
+        if ( symbols::findModule( addrs[i], module ) )
+        {
+            path = module.path;
+            offset = reinterpret_cast<const void*>( static_cast<const char*>( addrs[i] )
+                                                     - static_cast<const char*>( module.base ) );
+        }
+        else
+        {
+            // Code outside of modules is JIT which could be known from perf map
+            auto funcName = symbols::functionName( addrs[i] );
+            if ( !funcName.empty() )
+            {
+                entries[i] = { std::string( funcName ), "" };
+                resolved[i] = true;
+                continue;
+            }
+            // Modules are unknown if symbolizer is not available on this platform
+            path = "/proc/self/exe";
+        }
+        auto& group = groups[path];
+        group.offsets.push_back( offset );
+        group.idx.push_back( i );
+    }
+
+    std::vector<Entry> answers;
+    for ( auto& [path, group] : groups )
+    {
+        worker.resolverOf( path ).resolve( group.offsets, answers );
+        for ( std::size_t i = 0; i < answers.size(); i++ )
+        {
+            entries[group.idx[i]] = std::move( answers[i] );
+            resolved[group.idx[i]] = true;
+        }
+    }
 }
+#endif
 
-auto resolveAddr(const void* addr)
+// Ask the persistent cache and symbolizer first, then addr2line
+// Thread-safe
+SymbolEntry resolveAddr(const void* addr, bool needLine)
 {
-    static Addr2LineResolver a2l_resolver;
-    return a2l_resolver.request(addr);
+    SymbolEntry entry;
+    if ( resolveLocally( addr, needLine, entry ) )
+        return entry;
+#if BACKTRACE_USE_ADDR2LINE
+    return ResolverPool::get().request(addr);
+#else
+    return { addr ? "?\?" : "nullptr", "" };
+#endif
 }
 
-#endif // BACKTRACE_USE_ADDR2LINE
+// Resolve by addr2line in one round trip all addresses which are unknown to the cache and symbolizer,
+// so the following resolveAddr() calls take them from the cache.
+// Thread-safe
+void prefetchAddrs(void* const* addrs, int count, bool needLine)
+{
+#if BACKTRACE_USE_ADDR2LINE
+    std::vector<const void*> pending;
+    SymbolEntry entry;
+    for ( int i = 0; i < count; i++ )
+    {
+        if ( !resolveLocally( addrs[i], needLine, entry ) )
+            pending.push_back( addrs[i] );
+    }
+    ResolverPool::get().prefetch( pending.data(), static_cast<int>( pending.size() ) );
+#else
+    (void)addrs; (void)count; (void)needLine;
+#endif
+}
 
 #if BACKTRACE_AVAILABLE
 /***************************************************************************
@@ -440,13 +873,11 @@ std::string resolveAddr2Name(const void* addr, bool addLineNum /*=false*/, bool
         return ::tsv::util::tostr::hex_addr(addr) + " ?\?";
     }
 
-#if BACKTRACE_USE_ADDR2LINE
-    std::lock_guard<std::mutex> lock(debugResolverMutex);
-    auto symbolEntry = symbol_resolve::resolveAddr(addr);
+    // Resolving is thread-safe and doesn't need the lock
+    std::string symbol = symbol_resolve::resolveAddr( addr, addLineNum ).getSymbol( addLineNum );
     if ( !includeHexAddr )
-        return symbolEntry.getSymbol( addLineNum );
-    return ::tsv::util::tostr::hex_addr( addr ) + " " +symbolEntry.getSymbol( addLineNum );
-#endif
+        return symbol;
+    return ::tsv::util::tostr::hex_addr( addr ) + " " + symbol;
 }
 
 
@@ -471,19 +902,19 @@ std::vector<std::string> getStackTrace( int depth /*=-1*/, int skip /*=0*/)
     }
 
 #if BACKTRACE_AVAILABLE
-    static int localSkip = 0;  // offset to skip this function (0 is unitialized)
+    static std::atomic<int> localSkip{0};  // offset to skip this function (0 is unitialized)
 
     // Prepare values
     depth = depth < 0 ? 100 : depth;
     skip  = skip < 0  ? 0 : skip;
 
     // skip this function
-    skip += !localSkip ? 1 : localSkip;
+    skip += !localSkip.load() ? 1 : localSkip.load();
 
     depth += skip;
     depth =  depth > 100 ? 100 : depth;
 
-    std::lock_guard<std::mutex> lock(debugResolverMutex);
+    // Frames are resolved without the lock, it protects only the list of printed stacktraces
 
     // VLA syntax is supported by Clang/GCC
 //todo: warning: ISO C++ forbids variable length array �array� [-Wvla]
@@ -496,13 +927,21 @@ std::vector<std::string> getStackTrace( int depth /*=-1*/, int skip /*=0*/)
     // It is possible that backtrace() call could be also included into stacktrace
     // For example, LLVM with sanitizer includes it as ___interceptor_backtrace.
     // So dynamically detect on first call how many start entries really should be skipped
-    if (!localSkip && size>1)
+    if (!localSkip.load() && size>1)
     {
-        auto thisSymbol = symbol_resolve::resolveAddr( reinterpret_cast<void*>(tsv::debuglog::getStackTrace) );
-        auto symbolEntry = symbol_resolve::resolveAddr( array[1] );
-        localSkip = (symbolEntry.funcName_ == thisSymbol.funcName_) ? 2 : 1;
+        auto thisSymbol = symbol_resolve::resolveAddr( reinterpret_cast<void*>(tsv::debuglog::getStackTrace), false );
+        auto symbolEntry = symbol_resolve::resolveAddr( array[1], false );
+        localSkip.store( (symbolEntry.funcName_ == thisSymbol.funcName_) ? 2 : 1 );
     }
 
+    // Resolve all frames by one request to addr2line (only if the trace is going to be printed)
+    bool prefetched = false;
+    auto prefetch = [&]() {
+        if ( !prefetched )
+            symbol_resolve::prefetchAddrs( array+skip, depth-skip, resolve::settings::btIncludeLine );
+        prefetched = true;
+    };
+
     // Remember printed backtraces and later use its id only
     if ( resolve::settings::btShortList || resolve::settings::btShortListOnly )
     {
@@ -511,21 +950,32 @@ std::vector<std::string> getStackTrace( int depth /*=-1*/, int skip /*=0*/)
         static std::unordered_map< uint64_t, std::pair< std::string, int > > cachedStackTrace;
 
         uint64_t key = symbol_resolve::makeKey( array+skip, depth-skip );
+
+        // Return id of the stacktrace (other thread could remember the same one meanwhile)
+        auto remember = [&]( const std::string& shortName ) {
+            std::lock_guard<std::mutex> lock(debugResolverMutex);
+            int stackTraceId = static_cast<int>( cachedStackTrace.size() ) + 1;
+            return cachedStackTrace.emplace( key, std::make_pair( shortName, stackTraceId ) ).first->second.second;
+        };
+
+        std::unique_lock<std::mutex> lock(debugResolverMutex);
         auto it = cachedStackTrace.find( key );
-        if ( it != cachedStackTrace.end() )
+        bool repeated = ( it != cachedStackTrace.end() );
+        auto value = repeated ? it->second : std::pair< std::string, int >{};
+        lock.unlock();
+
+        if ( repeated )
         {
             // This stacktrace was already mentioned -- USE SHORT NOTATION ONLY (to make shorter output)
-            auto& value = it->second;
             return_value.push_back( TOSTR_FMT("StackTrace#{} - repeated: {}", value.second, value.first) );
             return return_value;
         }
         else if ( (depth-skip)==1 )
         {
             // This stacktrace wasn't mentioned before (special case with single entry). Remember it with path
-            auto symbolEntry = symbol_resolve::resolveAddr(array[skip]);
+            auto symbolEntry = symbol_resolve::resolveAddr(array[skip], resolve::settings::btIncludeLine);
             auto shortName = symbolEntry.getSymbol( resolve::settings::btIncludeLine );
-            int stackTraceId = cachedStackTrace.size()+1;
-            cachedStackTrace[ key ] = std::make_pair( shortName, stackTraceId );
+            int stackTraceId = remember( shortName );
 
             return_value.push_back( TOSTR_FMT( " .. StackTrace#{} : {}", stackTraceId, shortName ) );
         }
@@ -534,10 +984,11 @@ std::vector<std::string> getStackTrace( int depth /*=-1*/, int skip /*=0*/)
             // This stacktrace wasn't mentioned before. Remember it
 
             // (a) create function name list
+            prefetch();
             std::vector<std::string> tracedNames;
             for ( int i = skip; i < depth; i++ )
             {
-                auto symbolEntry = symbol_resolve::resolveAddr(array[i]);
+                auto symbolEntry = symbol_resolve::resolveAddr(array[i], false);
                 if ( !symbolEntry.funcName_.length() )
                    break;
                 tracedNames.push_back( symbolEntry.funcName_ );
@@ -547,8 +998,7 @@ std::vector<std::string> getStackTrace( int depth /*=-1*/, int skip /*=0*/)
 
             // (b) Create short notation and remember it
             std::string shortName( symbol_resolve::collapseNames( tracedNames ) );
-            int stackTraceId = cachedStackTrace.size()+1;
-            cachedStackTrace[ key ] = std::make_pair( shortName, stackTraceId );
+            int stackTraceId = remember( shortName );
 
             return_value.push_back( TOSTR_FMT( " .. StackTrace#{} : {}", stackTraceId, shortName ) );
         }
@@ -559,14 +1009,15 @@ std::vector<std::string> getStackTrace( int depth /*=-1*/, int skip /*=0*/)
         return return_value;
 
     // Fill lines-by-line stacktrace
+    prefetch();
     for ( int i = skip; i < depth; i++ )
     {
-        auto symbolEntry = symbol_resolve::resolveAddr(array[i]);
+        auto symbolEntry = symbol_resolve::resolveAddr(array[i], resolve::settings::btIncludeLine);
         if ( !symbolEntry.funcName_.length() )
            break;
 
         if ( resolve::settings::btIncludeAddr )
-            return_value.push_back( TOSTR_FMT( " .. #{:02}[{:x}] {}", i, array[i], symbolEntry.getSymbol( resolve::settings::btIncludeLine )) );
+            return_value.push_back( TOSTR_FMT( " .. #{:02}[{}] {}", i, static_cast<const void*>(array[i]), symbolEntry.getSymbol( resolve::settings::btIncludeLine )) );
         else
             return_value.push_back( TOSTR_FMT( " .. #{:02} {}", i, symbolEntry.getSymbol( resolve::settings::btIncludeLine ) ) );
         if (resolve::settings::backtraceStopWords.find(symbolEntry.funcName_) != resolve::settings::backtraceStopWords.end())
@@ -0,0 +1,589 @@
+/**
+  Purpose: In-process symbolizer - resolve code address to function name by ELF symbol tables
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+#include "debugsymbols.h"
+#include "debugdwarf.h"
+#include "debugresolve.h"
+#include "debuglog_singleton.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if __has_include(<link.h>) && __has_include(<sys/mman.h>)
+#define DEBUGLOG_SYMBOLIZER_AVAILABLE 1
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define DEBUGLOG_SYMBOLIZER_AVAILABLE 0
+#endif
+
+namespace tsv::debuglog::symbols
+{
+
+#if DEBUGLOG_SYMBOLIZER_AVAILABLE
+
+namespace
+{
+
+// Function symbol of the module (address relative to the load base)
+struct RawSymbol
+{
+    std::uintptr_t value;
+    std::uintptr_t size;
+    const char* name;
+    int priority;           // which of the symbols with the same address is preferred
+};
+
+// Mapped ELF file. Never unmapped, because symbol names point to it.
+struct ElfFile
+{
+    std::string path;
+    std::vector<RawSymbol> symbols;
+    dwarf::Sections debug;
+    std::string buildId;    // hex of NT_GNU_BUILD_ID note (empty if absent)
+
+    // Line table is built on the first request of file:line of this module
+    dwarf::LineTable& lines()
+    {
+        std::call_once(linesOnce_, [this] { lines_ = std::make_unique<dwarf::LineTable>(debug); });
+        return *lines_;
+    }
+
+private:
+    std::once_flag linesOnce_;
+    std::unique_ptr<dwarf::LineTable> lines_;
+};
+
+// Address range of the loaded module
+struct LoadedModule
+{
+    std::uintptr_t low;
+    std::uintptr_t high;
+    std::uintptr_t base;
+    ElfFile* file;
+};
+
+struct Function
+{
+    std::uintptr_t start;
+    std::uintptr_t size;
+    const char* name;
+    ElfFile* file;
+    std::uintptr_t base;    // load base of the module
+    int priority;
+};
+
+// Map the whole file for reading, return nullptr on fail
+const char* mapFile(const char* path, std::size_t& size)
+{
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    struct stat st{};
+    void* data = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        size = static_cast<std::size_t>(st.st_size);
+        data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    return data == MAP_FAILED ? nullptr : static_cast<const char*>(data);
+}
+
+// Take build-id from the notes of section
+void parseNotes(std::string_view notes, std::string& buildId)
+{
+    // Name and descriptor are aligned to 4 bytes in both classes
+    auto align = [](std::size_t value) { return (value + 3) & ~std::size_t{3}; };
+    while (notes.size() >= sizeof(ElfW(Nhdr)))
+    {
+        const auto* note = reinterpret_cast<const ElfW(Nhdr)*>(notes.data());
+        std::size_t nameSize = align(note->n_namesz);
+        std::size_t descSize = align(note->n_descsz);
+        if (nameSize + descSize > notes.size() - sizeof(ElfW(Nhdr)))
+            return;
+        const char* name = notes.data() + sizeof(ElfW(Nhdr));
+        if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0)
+        {
+            static const char kHex[] = "0123456789abcdef";
+            const auto* desc = reinterpret_cast<const unsigned char*>(name + nameSize);
+            buildId.clear();
+            for (std::size_t i = 0; i < note->n_descsz; i++)
+            {
+                buildId.push_back(kHex[desc[i] >> 4]);
+                buildId.push_back(kHex[desc[i] & 0xf]);
+            }
+            return;
+        }
+        notes.remove_prefix(sizeof(ElfW(Nhdr)) + nameSize + descSize);
+    }
+}
+
+// Collect function symbols of .symtab and .dynsym, find DWARF line sections and build-id
+void parseElf(const char* data, std::size_t size, ElfFile& file)
+{
+    if (size < sizeof(ElfW(Ehdr)))
+        return;
+    const auto* ehdr = reinterpret_cast<const ElfW(Ehdr)*>(data);
+    constexpr unsigned char kNativeClass = sizeof(void*) == 8 ? ELFCLASS64 : ELFCLASS32;
+    if (std::memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 || ehdr->e_ident[EI_CLASS] != kNativeClass)
+        return;
+    if (ehdr->e_shentsize != sizeof(ElfW(Shdr)) || ehdr->e_shoff == 0
+        || ehdr->e_shoff + std::size_t{ehdr->e_shnum} * sizeof(ElfW(Shdr)) > size)
+        return;
+
+    const auto* sections = reinterpret_cast<const ElfW(Shdr)*>(data + ehdr->e_shoff);
+    const ElfW(Shdr)* names = ehdr->e_shstrndx < ehdr->e_shnum ? &sections[ehdr->e_shstrndx] : nullptr;
+    if (names && (names->sh_offset + names->sh_size > size || names->sh_size == 0))
+        names = nullptr;
+    for (std::size_t idx = 0; idx < ehdr->e_shnum; idx++)
+    {
+        const auto& section = sections[idx];
+        if (section.sh_type == SHT_PROGBITS && names && section.sh_name < names->sh_size
+            && !(section.sh_flags & SHF_COMPRESSED) && section.sh_offset + section.sh_size <= size)
+        {
+            std::string_view name(data + names->sh_offset + section.sh_name,
+                                  strnlen(data + names->sh_offset + section.sh_name, names->sh_size - section.sh_name));
+            std::string_view content(data + section.sh_offset, section.sh_size);
+            if (name == ".debug_line")
+                file.debug.line = content;
+            else if (name == ".debug_line_str")
+                file.debug.lineStr = content;
+            else if (name == ".debug_str")
+                file.debug.str = content;
+            continue;
+        }
+        if (section.sh_type == SHT_NOTE && section.sh_offset + section.sh_size <= size)
+        {
+            parseNotes(std::string_view(data + section.sh_offset, section.sh_size), file.buildId);
+            continue;
+        }
+        if (section.sh_type != SHT_SYMTAB && section.sh_type != SHT_DYNSYM)
+            continue;
+        if (section.sh_link >= ehdr->e_shnum || section.sh_offset + section.sh_size > size)
+            continue;
+        const auto& strings = sections[section.sh_link];
+        if (strings.sh_size == 0 || strings.sh_offset + strings.sh_size > size
+            || data[strings.sh_offset + strings.sh_size - 1] != '\0')
+            continue;
+
+        // Full symbol table has also the local functions, so prefer its names
+        int tablePriority = section.sh_type == SHT_SYMTAB ? 4 : 0;
+        const auto* syms = reinterpret_cast<const ElfW(Sym)*>(data + section.sh_offset);
+        std::size_t count = section.sh_size / sizeof(ElfW(Sym));
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const auto& sym = syms[i];
+            // Layout of st_info is the same for both classes
+            auto type = ELF64_ST_TYPE(sym.st_info);
+            if ((type != STT_FUNC && type != STT_GNU_IFUNC) || sym.st_shndx == SHN_UNDEF || sym.st_value == 0
+                || sym.st_name == 0 || sym.st_name >= strings.sh_size)
+                continue;
+            auto bind = ELF64_ST_BIND(sym.st_info);
+            int priority = tablePriority + (bind == STB_GLOBAL ? 2 : (bind == STB_WEAK ? 1 : 0));
+            file.symbols.push_back({sym.st_value, sym.st_size, data + strings.sh_offset + sym.st_name, priority});
+        }
+    }
+}
+
+/**
+ * Immutable index of functions of all modules. Starts of functions are stored in Eytzinger
+ * order (children of the node k are 2k and 2k+1), so the first levels of the search share
+ * the same cache lines.
+ */
+class Index
+{
+public:
+    Index(std::vector<Function> functions, std::vector<LoadedModule> modules)
+        : functions_(std::move(functions)),
+          modules_(std::move(modules)),
+          keys_(functions_.size() + 1),
+          order_(functions_.size() + 1)
+    {
+        std::size_t next = 0;
+        build(next, 1);
+    }
+
+    const Function* find(std::uintptr_t addr) const
+    {
+        // Descend to the first start which is greater than addr
+        std::size_t n = functions_.size();
+        std::size_t k = 1;
+        while (k <= n)
+            k = 2 * k + (keys_[k] <= addr);
+        k >>= __builtin_ffsll(static_cast<long long>(~k));
+        std::size_t greater = k ? order_[k] : n;
+        if (greater == 0)
+            return nullptr;
+        const auto& function = functions_[greater - 1];
+        if (addr - function.start >= function.size)
+            return nullptr;
+        return &function;
+    }
+
+    const LoadedModule* findModule(std::uintptr_t addr) const
+    {
+        auto it = std::upper_bound(modules_.begin(), modules_.end(), addr,
+                                   [](std::uintptr_t value, const LoadedModule& m) { return value < m.low; });
+        if (it == modules_.begin() || addr >= (--it)->high)
+            return nullptr;
+        return &*it;
+    }
+
+private:
+    void build(std::size_t& next, std::size_t k)
+    {
+        if (k > functions_.size())
+            return;
+        build(next, 2 * k);
+        keys_[k] = functions_[next].start;
+        order_[k] = static_cast<std::uint32_t>(next);
+        next++;
+        build(next, 2 * k + 1);
+    }
+
+    std::vector<Function> functions_;       // sorted by start
+    std::vector<LoadedModule> modules_;     // sorted by low
+    std::vector<std::uintptr_t> keys_;      // [1..n] starts in Eytzinger order
+    std::vector<std::uint32_t> order_;      // [1..n] index of the key in functions_
+};
+
+class Symbolizer
+{
+public:
+    static Symbolizer& get()
+    {
+        return impl::leakedSingleton<Symbolizer>();
+    }
+
+    const Index& index()
+    {
+        if (auto* index = index_.load(std::memory_order_acquire))
+            return *index;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!index_.load(std::memory_order_relaxed))
+            rebuildLocked();
+        return *index_.load(std::memory_order_relaxed);
+    }
+
+    // Index which knows the module of `addr` if it is loaded by dlopen() after the index was built.
+    // It is rebuilt only if the set of loaded modules is changed since then.
+    const Index& indexFor(std::uintptr_t addr)
+    {
+        const auto& current = index();
+        if (current.findModule(addr))
+            return current;
+        auto generation = loadGeneration();
+        if (generation == generation_.load(std::memory_order_acquire))
+            return current;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation != generation_.load(std::memory_order_relaxed))
+            rebuildLocked();
+        return *index_.load(std::memory_order_relaxed);
+    }
+
+    void reload()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rebuildLocked();
+    }
+
+private:
+    struct Module
+    {
+        std::string path;
+        std::uintptr_t base;
+        std::uintptr_t low;     // range of loadable segments
+        std::uintptr_t high;
+    };
+
+    // Counters of loaded and unloaded modules (dlopen/dlclose)
+    static std::uint64_t loadGeneration()
+    {
+        std::uint64_t rv = 0;
+        dl_iterate_phdr([](dl_phdr_info* info, std::size_t size, void* context) {
+            if (size >= offsetof(dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs))
+                *static_cast<std::uint64_t*>(context) = info->dlpi_adds + info->dlpi_subs;
+            return 1;
+        }, &rv);
+        return rv;
+    }
+
+    // The previous index is leaked, because it could be in use
+    void rebuildLocked()
+    {
+        // Taken before the modules, so the module loaded meanwhile causes one more rebuild
+        auto generation = loadGeneration();
+        std::vector<Module> modules;
+        dl_iterate_phdr([](dl_phdr_info* info, std::size_t, void* context) {
+            auto& rv = *static_cast<std::vector<Module>*>(context);
+            // The first one is the executable itself
+            const char* path = (info->dlpi_name && info->dlpi_name[0]) ? info->dlpi_name
+                                                                      : (rv.empty() ? "/proc/self/exe" : nullptr);
+            if (!path)
+                return 0;
+            Module module{path, static_cast<std::uintptr_t>(info->dlpi_addr), ~std::uintptr_t{0}, 0};
+            for (int i = 0; i < info->dlpi_phnum; i++)
+            {
+                const auto& phdr = info->dlpi_phdr[i];
+                if (phdr.p_type != PT_LOAD)
+                    continue;
+                module.low = std::min<std::uintptr_t>(module.low, module.base + phdr.p_vaddr);
+                module.high = std::max<std::uintptr_t>(module.high, module.base + phdr.p_vaddr + phdr.p_memsz);
+            }
+            rv.push_back(module);
+            return 0;
+        }, &modules);
+
+        std::vector<Function> functions;
+        std::vector<LoadedModule> loaded;
+        for (const auto& module : modules)
+        {
+            auto& file = getFileLocked(module.path);
+            if (module.low < module.high)
+                loaded.push_back({module.low, module.high, module.base, &file});
+            for (const auto& sym : file.symbols)
+                functions.push_back({module.base + sym.value, sym.size, sym.name, &file, module.base, sym.priority});
+        }
+
+        // Keep one symbol per address (the most preferred)
+        std::sort(functions.begin(), functions.end(), [](const Function& a, const Function& b) {
+            return a.start != b.start ? a.start < b.start : a.priority > b.priority;
+        });
+        functions.erase(std::unique(functions.begin(), functions.end(),
+                                    [](const Function& a, const Function& b) { return a.start == b.start; }),
+                        functions.end());
+        // Symbols without size (assembler) last till the next function of the module
+        for (std::size_t i = 0; i + 1 < functions.size(); i++)
+        {
+            if (!functions[i].size && functions[i].file == functions[i + 1].file)
+                functions[i].size = functions[i + 1].start - functions[i].start;
+        }
+
+        std::sort(loaded.begin(), loaded.end(),
+                  [](const LoadedModule& a, const LoadedModule& b) { return a.low < b.low; });
+        index_.store(new Index(std::move(functions), std::move(loaded)), std::memory_order_release);
+        generation_.store(generation, std::memory_order_release);
+    }
+
+    ElfFile& getFileLocked(const std::string& path)
+    {
+        auto& file = files_[path];
+        if (!file)
+        {
+            file = std::make_unique<ElfFile>();
+            file->path = path;
+            if (path == "/proc/self/exe")
+            {
+                char buf[4096];
+                auto len = ::readlink(path.c_str(), buf, sizeof(buf) - 1);
+                if (len > 0)
+                    file->path.assign(buf, static_cast<std::size_t>(len));
+            }
+            std::size_t size = 0;
+            if (const char* data = mapFile(path.c_str(), size))
+                parseElf(data, size, *file);
+        }
+        return *file;
+    }
+
+    std::mutex mutex_;
+    std::atomic<const Index*> index_{nullptr};
+    std::atomic<std::uint64_t> generation_{0};  // loadGeneration() when index_ was built
+    std::unordered_map<std::string, std::unique_ptr<ElfFile>> files_;
+};
+
+/**
+ * Symbols of JIT code which runtimes (JVM, V8, LuaJIT...) write to /tmp/perf-<pid>.map
+ * as lines "START SIZE name" (hex). The file is read again if it is changed (checked each kCheckPeriod).
+ */
+class PerfMap
+{
+public:
+    static PerfMap& get()
+    {
+        return impl::leakedSingleton<PerfMap>();
+    }
+
+    bool lookup(std::uintptr_t addr, Symbol& symbol)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        if (now - checked_ >= kCheckPeriod)
+        {
+            checked_ = now;
+            refreshLocked();
+        }
+        auto it = std::upper_bound(functions_.begin(), functions_.end(), addr,
+                                   [](std::uintptr_t value, const Function& f) { return value < f.start; });
+        if (it == functions_.begin())
+            return false;
+        --it;
+        if (addr - it->start >= it->size)
+            return false;
+        symbol = {it->name, reinterpret_cast<const void*>(it->start), it->size, path_.c_str()};
+        return true;
+    }
+
+private:
+    friend PerfMap& impl::leakedSingleton<PerfMap>();
+    PerfMap()
+        : path_("/tmp/perf-" + std::to_string(::getpid()) + ".map")
+    {}
+
+    void refreshLocked()
+    {
+        struct stat st{};
+        if (::stat(path_.c_str(), &st) != 0)
+            st = {};
+        if (st.st_mtime == mtime_ && st.st_size == size_)
+            return;
+        mtime_ = st.st_mtime;
+        size_ = st.st_size;
+
+        functions_.clear();
+        FILE* file = std::fopen(path_.c_str(), "r");
+        if (!file)
+            return;
+        char* line = nullptr;
+        std::size_t capacity = 0;
+        ssize_t len;
+        while ((len = ::getline(&line, &capacity, file)) > 0)
+        {
+            if (line[len - 1] == '\n')
+                line[--len] = '\0';
+            char* end = nullptr;
+            auto start = std::strtoull(line, &end, 16);
+            auto size = std::strtoull(end, &end, 16);
+            while (*end == ' ')
+                end++;
+            if (!start || !size || !*end)
+                continue;
+            // Names are referred by returned symbols, so they are kept till the end of process
+            const char* name = names_.insert(end).first->c_str();
+            functions_.push_back({static_cast<std::uintptr_t>(start), static_cast<std::uintptr_t>(size), name,
+                                  nullptr, 0, 0});
+        }
+        std::free(line);
+        std::fclose(file);
+        // Later lines describe the recompiled code, so they win
+        std::stable_sort(functions_.begin(), functions_.end(),
+                         [](const Function& a, const Function& b) { return a.start < b.start; });
+        for (std::size_t i = 0; i + 1 < functions_.size(); i++)
+        {
+            if (functions_[i].start == functions_[i + 1].start)
+                functions_[i].size = 0;
+        }
+    }
+
+    // The file is checked for changes not often than that
+    static constexpr auto kCheckPeriod = std::chrono::milliseconds(100);
+
+    std::mutex mutex_;
+    std::string path_;
+    std::chrono::steady_clock::time_point checked_{};
+    time_t mtime_ = 0;
+    off_t size_ = 0;
+    std::vector<Function> functions_;   // sorted by start
+    std::unordered_set<std::string> names_;
+};
+
+}  // namespace
+
+bool lookup(const void* addr, Symbol& symbol)
+{
+    if (!addr)
+        return false;
+    auto address = reinterpret_cast<std::uintptr_t>(addr);
+    const auto& index = Symbolizer::get().indexFor(address);
+    const auto* function = index.find(address);
+    if (!function)
+        return !index.findModule(address) && PerfMap::get().lookup(address, symbol);
+    symbol = {function->name, reinterpret_cast<const void*>(function->start), function->size,
+              function->file->path.c_str()};
+    return true;
+}
+
+bool lookupLine(const void* addr, std::string_view& file, int& line)
+{
+    if (!addr)
+        return false;
+    auto address = reinterpret_cast<std::uintptr_t>(addr);
+    const auto* function = Symbolizer::get().indexFor(address).find(address);
+    if (!function || function->file->debug.line.empty())
+        return false;
+    return function->file->lines().find(address - function->base, file, line);
+}
+
+bool findModule(const void* addr, Module& module)
+{
+    if (!addr)
+        return false;
+    auto address = reinterpret_cast<std::uintptr_t>(addr);
+    const auto* loaded = Symbolizer::get().indexFor(address).findModule(address);
+    if (!loaded)
+        return false;
+    module = {loaded->file->path.c_str(), reinterpret_cast<const void*>(loaded->base), loaded->file->buildId};
+    return true;
+}
+
+void reload()
+{
+    Symbolizer::get().reload();
+}
+
+#else
+
+bool lookup(const void*, Symbol&)
+{
+    return false;
+}
+
+bool lookupLine(const void*, std::string_view&, int&)
+{
+    return false;
+}
+
+bool findModule(const void*, Module&)
+{
+    return false;
+}
+
+void reload()
+{
+}
+
+#endif
+
+std::string_view functionName(const void* addr)
+{
+    Symbol symbol;
+    if (!lookup(addr, symbol))
+        return {};
+    // Only C++ names are mangled (demangler would take "f" as "float")
+    if (std::strncmp(symbol.name, "_Z", 2) != 0)
+        return symbol.name;
+    return demangle(symbol.name);
+}
+
+}  // namespace tsv::debuglog::symbols
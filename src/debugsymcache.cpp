@@ -0,0 +1,389 @@
+/**
+  Purpose: Persistent cache of resolved symbols - keyed by build-id of the module and offset in it
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+*/
+
+#include "debugsymcache.h"
+#include "debugresolve.h"
+#include "debugsymbols.h"
+#include "debuglog_singleton.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tsv::debuglog::symcache
+{
+
+namespace
+{
+
+/**
+ * File layout (native byte order):
+ *    FileHeader
+ *    Record[count]      - sorted by offset
+ *    strings            - zero-terminated, referred by offset from the start of strings
+ */
+constexpr char kMagic[8] = {'D', 'L', 'S', 'Y', 'M', 'C', '1', '\0'};
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t count;
+    std::uint32_t stringsSize;
+};
+
+struct Record
+{
+    std::uint64_t offset;   // address relative to the load base of module
+    std::uint32_t name;
+    std::uint32_t path;
+};
+
+// Pending entries are written not often than that, and at exit
+constexpr auto kFlushPeriod = std::chrono::seconds(30);
+
+// Entries not written yet: offset -> {function name, " at file:line"}
+using Added = std::map<std::uint64_t, std::pair<std::string, std::string>>;
+
+// Cache of one module
+class ModuleCache
+{
+public:
+    explicit ModuleCache(std::string fileName)
+        : fileName_(std::move(fileName))
+    {
+        load();
+    }
+
+    ~ModuleCache()
+    {
+        unmap();
+    }
+
+    bool find(std::uint64_t offset, std::string& funcName, std::string& path) const
+    {
+        auto added = added_.find(offset);
+        if (added != added_.end())
+        {
+            funcName = added->second.first;
+            path = added->second.second;
+            return true;
+        }
+        auto it = std::lower_bound(records_, records_ + count_, offset,
+                                   [](const Record& r, std::uint64_t value) { return r.offset < value; });
+        if (it == records_ + count_ || it->offset != offset)
+            return false;
+        funcName = strings_ + it->name;
+        path = strings_ + it->path;
+        return true;
+    }
+
+    void store(std::uint64_t offset, std::string_view funcName, std::string_view path)
+    {
+        added_[offset] = {std::string(funcName), std::string(path)};
+    }
+
+    const std::string& fileName() const
+    {
+        return fileName_;
+    }
+
+    const Added& added() const
+    {
+        return added_;
+    }
+
+    // Merge the current content of the file with the `added` entries and replace it.
+    // The file could be written by other processes since this one was mapped, so it is read again
+    // under the lock shared by all processes which use the directory.
+    static bool write(const std::string& fileName, const std::string& lockName, const Added& added)
+    {
+        int lockFd = ::open(lockName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lockFd >= 0)
+            ::flock(lockFd, LOCK_EX);
+        bool ok = ModuleCache(fileName).writeMerged(added);
+        if (lockFd >= 0)
+            ::close(lockFd);
+        return ok;
+    }
+
+    // The `written` entries are in the file now, so map it again
+    void written(const Added& written)
+    {
+        for (auto& [offset, entry] : written)
+        {
+            auto it = added_.find(offset);
+            if (it != added_.end() && it->second == entry)
+                added_.erase(it);
+        }
+        unmap();
+        load();
+    }
+
+private:
+    bool writeMerged(const Added& added) const
+    {
+        std::vector<Record> records;
+        std::string strings;
+        auto addString = [&strings](std::string_view str) {
+            auto offset = static_cast<std::uint32_t>(strings.size());
+            strings.append(str).push_back('\0');
+            return offset;
+        };
+        auto it = added.begin();
+        for (std::uint32_t i = 0; i < count_ || it != added.end();)
+        {
+            if (it == added.end() || (i < count_ && records_[i].offset < it->first))
+            {
+                const auto& record = records_[i++];
+                records.push_back({record.offset, addString(strings_ + record.name), addString(strings_ + record.path)});
+                continue;
+            }
+            if (i < count_ && records_[i].offset == it->first)
+                i++;    // replaced by the new answer
+            records.push_back({it->first, addString(it->second.first), addString(it->second.second)});
+            ++it;
+        }
+
+        // Write to the temporary file and rename it, so readers never see partial content
+        std::string tmpName = fileName_ + ".tmp." + std::to_string(::getpid());
+        FILE* file = std::fopen(tmpName.c_str(), "wb");
+        if (!file)
+            return false;
+        FileHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.count = static_cast<std::uint32_t>(records.size());
+        header.stringsSize = static_cast<std::uint32_t>(strings.size());
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+                  && std::fwrite(records.data(), sizeof(Record), records.size(), file) == records.size()
+                  && std::fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok || std::rename(tmpName.c_str(), fileName_.c_str()) != 0)
+        {
+            std::remove(tmpName.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void load()
+    {
+        int fd = ::open(fileName_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(FileHeader))
+        {
+            mapSize_ = static_cast<std::size_t>(st.st_size);
+            void* data = ::mmap(nullptr, mapSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+            data_ = data == MAP_FAILED ? nullptr : static_cast<const char*>(data);
+        }
+        ::close(fd);
+        if (data_ && !validate())
+            unmap();
+    }
+
+    bool validate()
+    {
+        FileHeader header;
+        std::memcpy(&header, data_, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+            return false;
+        std::size_t stringsAt = sizeof(FileHeader) + std::size_t{header.count} * sizeof(Record);
+        if (stringsAt + header.stringsSize != mapSize_ || header.stringsSize == 0
+            || data_[mapSize_ - 1] != '\0')
+            return false;
+        records_ = reinterpret_cast<const Record*>(data_ + sizeof(FileHeader));
+        strings_ = data_ + stringsAt;
+        for (std::uint32_t i = 0; i < header.count; i++)
+        {
+            if (records_[i].name >= header.stringsSize || records_[i].path >= header.stringsSize
+                || (i && records_[i - 1].offset >= records_[i].offset))
+                return false;
+        }
+        count_ = header.count;
+        return true;
+    }
+
+    void unmap()
+    {
+        if (data_)
+            ::munmap(const_cast<char*>(data_), mapSize_);
+        data_ = nullptr;
+        mapSize_ = 0;
+        records_ = nullptr;
+        strings_ = nullptr;
+        count_ = 0;
+    }
+
+    std::string fileName_;
+    const char* data_ = nullptr;
+    std::size_t mapSize_ = 0;
+    const Record* records_ = nullptr;
+    const char* strings_ = nullptr;
+    std::uint32_t count_ = 0;
+    Added added_;   // not flushed yet
+};
+
+class SymCache
+{
+public:
+    static SymCache& get()
+    {
+        return impl::leakedSingleton<SymCache>();
+    }
+
+    bool find(const void* addr, std::string& funcName, std::string& path)
+    {
+        std::uint64_t offset = 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto* module = getModuleLocked(addr, offset);
+        return module && module->find(offset, funcName, path);
+    }
+
+    void store(const void* addr, std::string_view funcName, std::string_view path)
+    {
+        std::uint64_t offset = 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto* module = getModuleLocked(addr, offset))
+        {
+            module->store(offset, funcName, path);
+            if (!atExit_)
+            {
+                atExit_ = true;
+                std::atexit([] { SymCache::get().flush(); });
+            }
+        }
+    }
+
+    // Files are written without the mutex_, so lookups are not blocked meanwhile
+    void flush()
+    {
+        std::lock_guard<std::mutex> flushLock(flushMutex_);
+        std::vector<std::pair<std::shared_ptr<ModuleCache>, Added>> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            lastFlush_ = std::chrono::steady_clock::now();
+            for (auto& [buildId, module] : modules_)
+            {
+                if (!module->added().empty())
+                    pending.emplace_back(module, module->added());
+            }
+        }
+        if (pending.empty())
+            return;
+        auto dir = directory();
+        if (!makeDirectory(dir))
+            return;
+        for (auto& [module, added] : pending)
+        {
+            if (!ModuleCache::write(module->fileName(), dir + "/.lock", added))
+                continue;
+            std::lock_guard<std::mutex> lock(mutex_);
+            module->written(added);
+        }
+    }
+
+    void flushPeriodically()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (std::chrono::steady_clock::now() - lastFlush_ < kFlushPeriod)
+                return;
+        }
+        flush();
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        modules_.clear();
+    }
+
+private:
+    ModuleCache* getModuleLocked(const void* addr, std::uint64_t& offset)
+    {
+        symbols::Module module;
+        if (!symbols::findModule(addr, module) || module.buildId.empty())
+            return nullptr;
+        offset = static_cast<std::uint64_t>(static_cast<const char*>(addr) - static_cast<const char*>(module.base));
+        auto& cache = modules_[std::string(module.buildId)];
+        if (!cache)
+            cache = std::make_shared<ModuleCache>(directory() + "/" + std::string(module.buildId) + ".symcache");
+        return cache.get();
+    }
+
+    // Create the directory with its parents (like "mkdir -p")
+    static bool makeDirectory(const std::string& dir)
+    {
+        for (std::size_t pos = dir.find('/', 1); pos != std::string::npos; pos = dir.find('/', pos + 1))
+            ::mkdir(dir.substr(0, pos).c_str(), 0755);
+        struct stat st{};
+        return ::mkdir(dir.c_str(), 0755) == 0 || (::stat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode));
+    }
+
+    std::mutex flushMutex_;     // only one flush() writes files at once
+    std::mutex mutex_;          // guards members below
+    std::unordered_map<std::string, std::shared_ptr<ModuleCache>> modules_;    // by build-id
+    std::chrono::steady_clock::time_point lastFlush_ = std::chrono::steady_clock::now();
+    bool atExit_ = false;       // flush() is registered to be called at exit
+};
+
+}  // namespace
+
+bool find(const void* addr, std::string& funcName, std::string& path)
+{
+    return addr && SymCache::get().find(addr, funcName, path);
+}
+
+void store(const void* addr, std::string_view funcName, std::string_view path)
+{
+    if (addr)
+        SymCache::get().store(addr, funcName, path);
+}
+
+void flush()
+{
+    SymCache::get().flush();
+}
+
+void flushPeriodically()
+{
+    SymCache::get().flushPeriodically();
+}
+
+void reset()
+{
+    SymCache::get().reset();
+}
+
+std::string directory()
+{
+    if (!resolve::settings::btCacheDir.empty())
+        return resolve::settings::btCacheDir;
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && xdg[0] == '/')
+        return std::string(xdg) + "/debuglog";
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : "/tmp") + "/.cache/debuglog";
+}
+
+}  // namespace tsv::debuglog::symcache
@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+  Purpose: Reader of DWARF line tables (.debug_line v2..v5) - resolve code address to file:line
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Used by the in-process symbolizer (see debugsymbols.h) over the mapped ELF file.
+  The constructor only scans the line programs to know which address ranges belong to which
+  unit. The rows of the unit are decoded into the compact sorted table on the first lookup
+  of its address. Decoded units are kept till the end of the process.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tsv::debuglog::dwarf
+{
+
+// Content of the sections of ELF file (empty if absent)
+struct Sections
+{
+    std::string_view line;      // .debug_line
+    std::string_view lineStr;   // .debug_line_str
+    std::string_view str;       // .debug_str
+};
+
+class LineTable
+{
+public:
+    explicit LineTable(const Sections& sections);
+    ~LineTable();
+
+    // `addr` is the link-time address (relative to the load base for shared objects).
+    // Return false if there is no line info for it.
+    bool find(std::uintptr_t addr, std::string_view& file, int& line);
+
+    bool empty() const
+    {
+        return ranges_.empty();
+    }
+
+private:
+    struct Rows;
+
+    // Addresses of the one sequence of the unit
+    struct Range
+    {
+        std::uintptr_t low;
+        std::uintptr_t high;
+        std::uint32_t unit;
+    };
+
+    struct Unit
+    {
+        std::size_t offset;                     // of the header in .debug_line
+        std::atomic<const Rows*> rows{nullptr}; // decoded on the first use
+    };
+
+    const Rows* getRows(Unit& unit);
+
+    Sections sections_;
+    std::vector<Range> ranges_;     // sorted by low
+    std::unique_ptr<Unit[]> units_;
+    std::mutex mutex_;
+};
+
+}  // namespace tsv::debuglog::dwarf
@@ -18,6 +18,8 @@
 // Include extra headers only if logger turned on
 #include "debugresolve.h"
 #include "tostr.h"
+#include "debuglog_deferred.h"
+#include "debuglog_throttle.h"
 
 #else
 
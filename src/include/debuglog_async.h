@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+  Purpose: Asynchronous output of the logger lines
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  When the mode is active, SentryLogger::write() only formats the line and enqueues it into
+  the per-thread ring buffer. Dedicated writer thread drains these buffers and calls the output handler.
+  So slow output handler doesn't stall threads which do logging.
+*/
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "debuglog_enum.h"
+
+namespace tsv::debuglog::async
+{
+
+// What to do if the ring buffer of the thread is full
+enum class Overflow
+{
+    Block,          // wait until the writer takes some records
+    DropNewest,     // ignore the record which doesn't fit
+    DropOldest      // throw away the oldest record in the buffer to put the new one
+};
+
+struct Args
+{
+    std::size_t bufferSize = 1024;  // number of records in the per-thread ring buffer (rounded up to power of 2)
+    Overflow overflow = Overflow::Block;
+    int flushIntervalMs = 10;       // how often the writer checks buffers if nobody wake it up
+};
+
+typedef void (*OutputHandler)(sentry_enum::Level level, sentry_enum::Kind kind, std::string_view str);
+// Render the record payload into the line. Called by the writer thread.
+typedef void (*RenderFn)(std::string_view payload, std::string& line);
+// Serialize the record payload. Called by the producer thread.
+typedef void (*FillFn)(std::string& payload, const void* context);
+
+// Start the writer thread. Return false if it is already started
+bool start(Args args = {});
+
+// Drain all buffers and stop the writer thread. Next lines are written synchronously.
+// @note: Called automatically at exit. Lines logged by other threads concurrently with stop() may be lost.
+void stop();
+
+// Wait until all records enqueued before this call are passed to the output handler
+void flush();
+
+bool isActive();
+
+// Enqueue the line to be passed to the handler by the writer thread.
+// Return false if asynchronous mode is not active, so caller should call the handler by itself.
+bool push(OutputHandler handler, sentry_enum::Level level, sentry_enum::Kind kind, std::string_view line);
+
+// Enqueue the payload serialized by fill(payload, context). The writer thread renders it with render()
+// before passing to the handler. If asynchronous mode is not active, return false without calling fill().
+bool push(OutputHandler handler,
+          sentry_enum::Level level,
+          sentry_enum::Kind kind,
+          RenderFn render,
+          FillFn fill,
+          const void* context);
+
+}  // namespace tsv::debuglog::async
@@ -0,0 +1,161 @@
+#pragma once
+
+/**
+  Purpose: Deferred formatting of SAY_ARGS_DEFERRED / SAY_FMT_DEFERRED
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Call site keeps static descriptor (format or names of arguments, file, line) and only copies
+  raw values of arguments. Text is rendered later by the writer thread of asynchronous mode
+  (see "debuglog_async.h"). If the mode is not active, text is rendered immediately.
+
+  Only arithmetic, enum and string (char*, std::string, std::string_view) arguments are accepted.
+  Strings are copied, so it is safe to pass temporaries.
+  Format string is checked when the line is rendered. If it doesn't match the arguments,
+  the error is printed instead of the line.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include "tostr.h"
+#include "tostr_fmt_include.h"
+
+namespace tsv::debuglog::deferred
+{
+
+// Static descriptor of the call site
+struct Site
+{
+    const char* fmt;            // format string for SAY_FMT_DEFERRED, nullptr for SAY_ARGS_DEFERRED
+    const ::tsv::util::tostr::ArgName* names;  // names of arguments for SAY_ARGS_DEFERRED
+    const char* file;
+    int line;
+};
+
+namespace impl
+{
+
+template <typename T>
+constexpr bool isCharPtr = std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+template <typename T>
+constexpr bool isSupported = std::is_arithmetic_v<T> || std::is_enum_v<T> || isCharPtr<T>
+                             || std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+// Type of argument as it is stored in the payload (arrays are decayed to pointer)
+template <typename T>
+using Stored = std::conditional_t<isCharPtr<std::decay_t<T>>, const char*, std::decay_t<T>>;
+
+// Type in which argument is passed to fill() (keep decayed pointer by value)
+template <typename T>
+using Ref = std::conditional_t<isCharPtr<T>, const char*, const T&>;
+
+constexpr std::uint32_t kNullStr = ~std::uint32_t{0};
+
+inline void encodeStr(std::string& buf, const char* data, std::size_t size)
+{
+    auto len = static_cast<std::uint32_t>(size);
+    buf.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    buf.append(data, size);
+    buf.push_back('\0');
+}
+
+template <typename T>
+void encode(std::string& buf, const T& value)
+{
+    if constexpr (isCharPtr<T>)
+    {
+        if (value)
+            encodeStr(buf, value, std::strlen(value));
+        else
+            buf.append(reinterpret_cast<const char*>(&kNullStr), sizeof(kNullStr));
+    }
+    else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+        encodeStr(buf, value.data(), value.size());
+    else
+        buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T decode(const char*& pos)
+{
+    if constexpr (isCharPtr<T> || std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+    {
+        std::uint32_t len;
+        std::memcpy(&len, pos, sizeof(len));
+        pos += sizeof(len);
+        if (len == kNullStr)
+            return T{};
+        const char* str = pos;
+        pos += len + 1;
+        if constexpr (isCharPtr<T>)
+            return str;
+        else
+            return T(str, len);
+    }
+    else
+    {
+        T value;
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+}
+
+// Payload is: Site*, args...
+template <typename... Args>
+void fill(std::string& buf, const void* context)
+{
+    const auto& args = *static_cast<const std::tuple<const Site*, Ref<Args>...>*>(context);
+    std::apply([&](const Site* site, const auto&... values) {
+        buf.append(reinterpret_cast<const char*>(&site), sizeof(site));
+        (encode<Args>(buf, values), ...);
+    }, args);
+}
+
+template <typename... Args>
+void render(std::string_view payload, std::string& body)
+{
+    const char* pos = payload.data();
+    const Site* site;
+    std::memcpy(&site, pos, sizeof(site));
+    pos += sizeof(site);
+
+    // Braced initialization guarantees left-to-right order of decoding
+    std::tuple<Args...> values{decode<Args>(pos)...};
+    try
+    {
+        std::apply([&](const auto&... v) {
+            if (site->fmt)
+                body = TOSTR_VFMT(site->fmt, v...);
+            else
+                body = ::tsv::util::tostr::Printer<sizeof...(Args)>(::tsv::util::tostr::Mode::Args, site->names)
+                           .do_print(v...);
+        }, values);
+    }
+    catch (const std::exception& e)
+    {
+        // Format string is checked only here (possibly in the writer thread), so report it instead of terminate
+        body = "[debuglog] bad format \"" + std::string(site->fmt ? site->fmt : "") + "\" at " + site->file + ":"
+               + std::to_string(site->line) + ": " + e.what();
+    }
+}
+
+}  // namespace impl
+
+template <typename Logger, typename... Args>
+void print(Logger& logger, const Site& site, const Args&... args)
+{
+    static_assert((impl::isSupported<impl::Stored<Args>> && ...),
+                  "SAY_*_DEFERRED accepts only arithmetic, enum and string arguments");
+    std::tuple<const Site*, impl::Ref<impl::Stored<Args>>...> context{&site, args...};
+    logger.printDeferred(&impl::render<impl::Stored<Args>...>, &impl::fill<impl::Stored<Args>...>, &context);
+}
+
+}  // namespace tsv::debuglog::deferred
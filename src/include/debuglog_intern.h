@@ -0,0 +1,23 @@
+#pragma once
+
+/**
+  Purpose: Process-wide table of interned strings
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Interned string is never freed, so its reference could be kept by anyone (context names,
+  demangled type names) and is valid even in the destructors of statics.
+*/
+
+#include <string>
+#include <string_view>
+
+namespace tsv::debuglog
+{
+
+// Stable copy of the `str`. Lookup is first done in the small per-thread direct-mapped cache
+// keyed by the address of `str` (the content is verified), the global table is locked only on its miss.
+const std::string& internString(std::string_view str);
+
+}  // namespace tsv::debuglog
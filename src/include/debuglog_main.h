@@ -13,8 +13,15 @@
               otherwise DEBUG_LOGGING / DEBUGLOG_CATEG switching will not work
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include "debuglog_enum.h"
+#include "debuglog_async.h"
+#include "debuglog_sites.h"
 
 /**
   * DEBUG_LOGGING - determine if SentryLogger macros generate output (SENTRY_*, SAY_*, SAY_DBG)
@@ -98,6 +105,20 @@ static_assert(false __VA_W_COMMA(), "Unable to correctly concatenate empty __VA_
 #define SAY_JOIN( ...)  SENTRYLOGGER_PRINT()( TOSTR_JOIN(__VA_ARGS__) )
 #define SAY_FMT(...)    SENTRYLOGGER_PRINT()( TOSTR_FMT(__VA_ARGS__) )
 
+// Deferred variants. Only raw values of arguments are copied here, and the text is rendered later
+// by the writer thread of asynchronous output. Arguments must be arithmetic, enum or strings (see "debuglog_deferred.h")
+#define SAY_ARGS_DEFERRED(...)        SENTRYLOGGER_PRINT_DEFERRED(nullptr, __VA_ARGS__)
+#define SAY_FMT_DEFERRED(...)         SENTRYLOGGER_PRINT_DEFERRED(__VA_ARGS__)
+
+// Throttled variants. First argument is the policy of the call site: everyN(n), firstN(n) or perSecond(n)
+// where n is a constant (see "debuglog_throttle.h"). Suppressed calls do not evaluate arguments.
+#define SAY_DBG_THROTTLED(spec, ...)    SENTRYLOGGER_PRINT_THROTTLED(spec)( __VA_ARGS__)
+#define SAY_ARGS_THROTTLED(spec, ...)   SENTRYLOGGER_PRINT_THROTTLED(spec)( TOSTR_ARGS(__VA_ARGS__) )
+#define SAY_FMT_THROTTLED(spec, ...)    SENTRYLOGGER_PRINT_THROTTLED(spec)( TOSTR_FMT(__VA_ARGS__) )
+// Suppressed scope is silent as a whole (enter/leave, all messages inside and nested sentries)
+#define SENTRY_FUNC_THROTTLED(spec, ...) SENTRYLOGGER_CREATE_THROTTLED(spec, __PRETTY_FUNCTION__, "" __VA_W_COMMA(__VA_ARGS__))
+#define SENTRY_CONTEXT_THROTTLED(spec, context, ...) SENTRYLOGGER_CREATE_THROTTLED(spec, "|" __FILE__ ":" DEBUGLOG_STRINGIZE(__LINE__), context __VA_W_COMMA(__VA_ARGS__))
+
 #define SAY_STACKTRACE(...)  EXECUTE_IF_DEBUGLOG( if (sentryLogger.isAllowedStage(SentryLogger::Stage::Event)) sentryLogger.printStackTrace(__VA_ARGS__))
 #define SAY_AND_RETURN(arg, ...) EXECUTE_IF_DEBUGLOG2( \
             {decltype(auto) rv = arg; if (sentryLogger.isAllowed(SentryLogger::Stage::Leave)) sentryLogger.setReturnValueStr( ::tsv::util::tostr::toStr(rv, ::tsv::util::tostr::ENUM_TOSTR_REPR) + TOSTR_JOIN(__VA_ARGS__) ); return rv; }, \
@@ -131,10 +152,13 @@ namespace tsv::debuglog
         bool isAllowed(...) const { return false; }
         bool isAllowedStage(...) const { return false; }
         bool isAllowedAndSetTempLevel(...) { return false; }
+        bool isSiteAllowedAndSetTempLevel(sites::Site&, ...) { return false; }
+        void applySite(sites::Site&, ...) {}
         void printStackTrace() const {}
         void printStackTrace(const StackTraceArgs& , ...) const {}
         void setReturnValueStr(std::string ) {}
         void print([[maybe_unused]]std::string_view content = "") {}
+        void printDeferred(...) {}
         void setLogLevel(...) {}
         void setFlag(...) {}
         bool checkFlags(...) const {return false;}
@@ -150,12 +174,40 @@ namespace tsv::debuglog
 namespace tsv::debuglog 
 {
 
+namespace recorder
+{
+class Recorder;
+}
+
+// Capacity of the per-thread sentries stack. Deeper sentries are still counted
+// in the nesting level, but are invisible for getLast()
+#ifndef DEBUGLOG_SENTRY_STACK_DEPTH
+#define DEBUGLOG_SENTRY_STACK_DEPTH 256
+#endif
+
+class SentryLogger;
+
+namespace impl
+{
+// Stack of active sentries. Each thread has its own one, so no shared writes on enter/leave scope.
+struct SentryStack
+{
+    int depth;                                          // current nesting level (could exceed capacity)
+    int suppressedFrom;                                 // if not 0 - nesting level of the suppressed subtree
+    SentryLogger* items[DEBUGLOG_SENTRY_STACK_DEPTH];   // [1..depth] are active sentries, [0] is unused (root)
+};
+
+// @note: inline with constant initializer, so accessed directly without TLS wrapper call
+inline thread_local SentryStack sentryStack_t{};
+}  // namespace impl
+
 /**
  * Core class
  */
 class SentryLogger
 {
        friend class Settings;
+       friend class recorder::Recorder;
 
     public:
        // All enums of the class matches to this type
@@ -169,9 +221,12 @@ class SentryLogger
            SuppressEnter  = 1<<1,
            SuppressLeave  = 1<<2,
            SuppressEvents = 1<<3,
-           Timer          = 1<<4, // turn on time tracking (ms resolution)
+           Timer          = 1<<4, // turn on time tracking (print processing time)
            Force          = 1<<5, // if true, all kinds and all stages if not out of loglevel
            AppendContextName = 1<<6, // if true, the contextName will be "PreviousContextName--ThisContextName"
+           Stats          = 1<<7, // add processing time to statistics of the context (see "debuglog_stats.h")
+           TailBuffer     = 1<<8, // keep lines of the scope and subscopes, print them at the end only if
+                                  // an error happens or the scope takes longer than InitArgs::tailThresholdUs
            SuppressBorders = SuppressEnter|SuppressLeave
        };
 
@@ -192,6 +247,8 @@ class SentryLogger
            // Track in scope of sentry and subcalls the object "kind:object" (logobjects::isAllowedObj()==true)
            // That is to show in the enter message content of "this" if its output is limited
            void* object = nullptr;
+           // For Flags::TailBuffer: print collected lines if the scope takes longer (0 = only on error)
+           std::uint64_t tailThresholdUs = 0;
        };
 
     public:
@@ -206,42 +263,168 @@ class SentryLogger
             : SentryLogger(prettyName, name, InitArgs{})
         {}
 
-        SentryLogger(const char* prettyName, std::string_view name, InitArgs args);
+        SentryLogger(const char* prettyName, std::string_view name, InitArgs args)
+            : SentryLogger(prettyName, name, args, false)
+        {}
+        // Literal name outlives the sentry, so it is interned only on the first use (see getContextName())
+        template <std::size_t N>
+        SentryLogger(const char* prettyName, const char (&name)[N], InitArgs args = {})
+            : SentryLogger(prettyName, std::string_view(name), args, true)
+        {}
+        // .. but the content of mutable buffer is copied right away
+        template <std::size_t N>
+        SentryLogger(const char* prettyName, char (&name)[N], InitArgs args = {})
+            : SentryLogger(prettyName, std::string_view(name), args, false)
+        {}
         SentryLogger(Level level,
                      std::string_view name,
                      bool appendContextFlag = true,
                      Kind kind = Kind::Default);
-        ~SentryLogger();
+        ~SentryLogger()
+        {
+            if (dormant_)
+            {
+                auto& stack = impl::sentryStack_t;
+                if (stackIdx_ == stack.depth)
+                {
+                    stack.depth--;
+                    return;
+                }
+            }
+            leave();
+        }
 
         SentryLogger(const SentryLogger&) = delete;
         SentryLogger& operator=(const SentryLogger&) = delete;
 
+    private:
+        SentryLogger(const char* prettyName, std::string_view name, InitArgs args, bool literalName)
+        {
+            // Fast path: the sentry which can't print anything under the current settings
+            // is just placed to the stack (see wake())
+            auto level = (args.level == Level::Default) ? enablement_s.getDefaultLevel() : args.level;
+            if (args.enabled && !args.object && !checkFlags(args.flags, kActiveFlags) && level <= Level::Off
+                && !(enablement_s.isLevelAllowed(level) && enablement_s.isKindAllowed(args.kind)))
+            {
+                flags_ = args.flags;
+                logLevel_ = level;
+                mainLogLevel_ = level;
+                kind_ = (args.kind < Kind::Off) ? Kind::Off : args.kind;
+                prettyName_ = prettyName;
+                if (!name.empty())
+                {
+                    contextName_ = literalName ? name : internName(name);
+                    rawName_ = literalName;
+                }
+                dormant_ = true;
+
+                auto& stack = impl::sentryStack_t;
+                stackIdx_ = ++stack.depth;
+                if (stackIdx_ < DEBUGLOG_SENTRY_STACK_DEPTH)
+                    stack.items[stackIdx_] = this;
+            }
+            else
+            {
+                init(prettyName, name, args);
+            }
+        }
+
+    public:
+
         void printStackTrace();
         void printStackTrace(StackTraceArgs args, Level level = Level::This);
         void print(std::string_view content = "");
+        // Print content serialized by fill() and rendered by render() (see SAY_*_DEFERRED)
+        void printDeferred(async::RenderFn render, async::FillFn fill, const void* context);
 
         // Check stage only
-        bool isAllowedStage(Stage stage) const;
+        bool isAllowedStage(Stage stage) const
+        {
+            return checkFlags(Flags::Force) || isStageAllowed(stage);
+        }
         bool isAllowed(Stage stage) const
         {
+            // Dormant sentry skipped its enter line, so it has no borders at all
+            if (dormant_)
+                return stage == Stage::Event && isAllowed(stage, mainLogLevel_, kind_);
+            if (forcedBorders_ && stage != Stage::Event)
+                return !isSubtreeSuppressed();
             return isAllowed(stage, mainLogLevel_, kind_);
         }
-        bool isAllowed(Stage stage, Level level, Kind kind) const;
-        bool isAllowedAndSetTempLevel(Stage stage, Level level);
+        bool isAllowed(Stage stage, Level level, Kind kind) const
+        {
+            return enablement_s.isLevelAllowed(level) && !isSubtreeSuppressed()
+                   && (checkFlags(Flags::Force) || (isStageAllowed(stage) && enablement_s.isKindAllowed(kind)));
+        }
+        bool isAllowedAndSetTempLevel(Stage stage, Level level)
+        {
+            if (!isAllowed(stage, level, kind_))
+                return false;
+            // Only update current loglevel only for allowed because it is reseted in write()
+            logLevel_ = level;
+            return true;
+        }
         bool isAllowedAndSetTempLevel(Stage stage)
         {
             return isAllowedAndSetTempLevel(stage, logLevel_);
         }
+        // Check the runtime state of the SAY_* call site first (see "debuglog_sites.h")
+        bool isSiteAllowedAndSetTempLevel(sites::Site& site, const char* function, Stage stage, Level level)
+        {
+            switch (site.getState(function, kind_))
+            {
+                case sites::State::Off:
+                    return false;
+                case sites::State::On:
+                    if (isSubtreeSuppressed())
+                        return false;
+                    logLevel_ = std::min(level, enablement_s.getLogLevel());
+                    return true;
+                default:
+                    return isAllowedAndSetTempLevel(stage, level);
+            }
+        }
+        bool isSiteAllowedAndSetTempLevel(sites::Site& site, const char* function, Stage stage)
+        {
+            return isSiteAllowedAndSetTempLevel(site, function, stage, logLevel_);
+        }
+        // Apply the runtime state of the SENTRY_* call site to the just created sentry
+        void applySite(sites::Site& site, const char* function)
+        {
+            auto state = site.getState(function, kind_);
+            if (state == sites::State::Off)
+                setLogLevel(Level::Off);
+            else if (state == sites::State::On)
+                forceSite();
+        }
 
         Level getLogLevel() const { return logLevel_; }
         void setLogLevel(Level level);
+        // Turn off output of this sentry and of everything nested into it on this thread till the scope end
+        void suppressSubtree();
+        static bool isSubtreeSuppressed()
+        {
+            return impl::sentryStack_t.suppressedFrom != 0;
+        }
+        // Printed by level and allowed by kind regardless of suppressed stages
+        // (used for statistics, trace and throttling of the scope)
+        bool isScopeAllowed() const
+        {
+            return !dormant_
+                   && (forcedBorders_
+                       || (enablement_s.isLevelPrinted(mainLogLevel_)
+                           && (checkFlags(Flags::Force) || enablement_s.isKindAllowed(kind_))));
+        }
 
         void setFlag(Flags flags, bool enable = true);
         auto getFlags() const { return flags_; }
-        bool checkFlags(Flags flags) const;
+        bool checkFlags(Flags flags) const
+        {
+            return static_cast<EnumType_t>(flags_) & static_cast<EnumType_t>(flags);
+        }
 
         Kind getKind() const { return kind_; }
-        const std::string& getContextName();
+        std::string_view getContextName();
         Level transformLogLevel(Level level) const;
 
         void setReturnValueStr(std::string rv);
@@ -266,23 +449,171 @@ class SentryLogger
                    std::string_view suffix);
 
     private:
+        /**
+         * Precomputed from Settings state for the quick inline checks.
+         * Rebuilt by Settings each time when the log level or state of kinds is changed.
+         */
+        // Hot copy of Settings::Snapshot values. Refreshed by each publish of the snapshot.
+        // Fields are independent relaxed atomics, so a check could momentarily see
+        // a mix of values across the publish, but never torn value.
+        struct alignas(64) EnablementTable
+        {
+            // Kinds above this are checked by the slow path
+            static constexpr EnumType_t kMaxKinds = 64;
+
+            std::atomic<std::uint64_t> kindMask;              // bit is set if the kind is allowed
+            std::atomic<std::uint8_t> logLimit;               // max(log level, capture level) + 1
+            std::atomic<std::uint8_t> printLimit;             // Settings::getLogLevel() + 1
+            std::atomic<std::uint8_t> defaultLevel;           // Settings::getDefaultLevel()
+            std::atomic<std::uint8_t> kindLevel[kMaxKinds];   // Settings::getLoggerKindStateAsLevel()
+
+            bool isLevelAllowed(Level level) const
+            {
+                return static_cast<EnumType_t>(level) < logLimit.load(std::memory_order_relaxed);
+            }
+            // Passed to the output handler (otherwise captured by the flight recorder)
+            bool isLevelPrinted(Level level) const
+            {
+                return static_cast<EnumType_t>(level) < printLimit.load(std::memory_order_relaxed);
+            }
+            bool isKindAllowed(Kind kind) const
+            {
+                auto idx = static_cast<EnumType_t>(kind);
+                if (idx < kMaxKinds)
+                    return (kindMask.load(std::memory_order_relaxed) >> idx) & 1;
+                return isKindAllowedSlow(kind);
+            }
+            Level getKindStateAsLevel(Kind kind) const
+            {
+                auto idx = static_cast<EnumType_t>(kind);
+                if (idx < kMaxKinds)
+                    return static_cast<Level>(kindLevel[idx].load(std::memory_order_relaxed));
+                return getKindStateAsLevelSlow(kind);
+            }
+            Level getLogLevel() const
+            {
+                return static_cast<Level>(printLimit.load(std::memory_order_relaxed) - 1);
+            }
+            Level getDefaultLevel() const
+            {
+                return static_cast<Level>(defaultLevel.load(std::memory_order_relaxed));
+            }
+        };
+        static EnablementTable enablement_s;
+
+        // Force output of enter/leave lines of the sentry regardless of its level, kind and suppressed stages.
+        // Lines in its scope follow their own sites
+        void forceSite();
+        // Full construction and destruction (see the inline fast path of dormant sentry)
+        void init(const char* prettyName, std::string_view name, InitArgs args);
+        void leave();
+        // Exclude the sentry from the stack of the current thread
+        void removeFromStack();
+        // Dormant sentry becomes a regular one when its level or flags are changed
+        void wake();
+        static std::string_view internName(std::string_view name);
+        static bool checkFlags(Flags flags, Flags mask)
+        {
+            return static_cast<EnumType_t>(flags) & static_cast<EnumType_t>(mask);
+        }
+        // Print or drop lines collected in scope of the sentry with Flags::TailBuffer
+        static void flushTail();
+
+        static bool isKindAllowedSlow(Kind kind);
+        static Level getKindStateAsLevelSlow(Kind kind);
+
+        bool isStageAllowed(Stage stage) const
+        {
+            // trick: stages match to corresponding Suppress flags
+            return !(static_cast<EnumType_t>(flags_) & static_cast<EnumType_t>(stage));
+        }
+
+        // Context name for the __PRETTY_FUNCTION__ or "|/path/to/file:lineno"
+        static std::string makeContextName(const char* prettyName);
+        // Add time since startTime_ to the statistics of the context
+        void recordStats();
+        // Level of enter/leave lines (the forced site is cut to the global log level)
+        Level getBordersLevel() const
+        {
+            return forcedBorders_ ? std::min(logLevel_, enablement_s.getLogLevel()) : logLevel_;
+        }
+
+        // Attributes of the output line besides its text
+        struct LineInfo
+        {
+            int depth;
+            Kind kind;
+            Level level;
+            char nestedSym;
+            std::int64_t time = 0;              // system clock (ns), 0 = now
+            int threadId = 0;                   // 0 = current thread
+            std::string_view threadName{};      // interned name of the threadId
+        };
+        // Fill time and thread of the line by the current ones
+        static void setOrigin(LineInfo& info);
+
+        // Format the line and pass it to the output handler
+        static void emit(const LineInfo& info,
+                         std::string_view contextName,
+                         std::string_view prefix,
+                         std::string_view body,
+                         std::string_view suffix);
+        // Append the line formatted by Settings::getLineLayout() to the `out`
+        static void formatLine(std::string& out,
+                               const LineInfo& info,
+                               std::string_view contextName,
+                               std::string_view prefix,
+                               std::string_view body,
+                               std::string_view suffix);
+        // Render the line of SAY_*_DEFERRED
+        static void renderDeferred(std::string_view payload, std::string& line);
+
+    private:
+        // Position in the per-thread stack of sentries (0 = root, <0 = not placed to the stack)
+        // @note: declared first because parent lookup could be done during members initialization
+        int stackIdx_ = -1;
+
         Flags flags_;
         Level logLevel_;     // current log level (could temporary differ from main after setTempLevel)
         Level mainLogLevel_; // the sentry log level (reset to this after each print)
         Kind kind_;
-        void* relatedObj_;
 
-        std::string contextName_{};
+        std::string_view contextName_{};   // interned name (or empty till first getContextName())
         // Initialized with string literal for lazy transform to context name.
         // For the SENTRY_FUNC that is a __PRETTY_FUNCTION__
         // For the SENTRY_CONTEXT that is a "|/path/to/file:lineno" (as default for no context)
         const char* prettyName_ = nullptr;
 
-        double startTime_ = 0.0;        // if not 0.0 - starttime since epoch
-        static int currentLevel_s;      // current level (depth)
-        SentryLogger* prevSentry_;      // uni-direction backward linked list of sentries
+        // Created by the fast path: nothing to print, only placed to the stack
+        bool dormant_ = false;
+        // contextName_ is a literal given to the dormant sentry, not interned yet
+        bool rawName_ = false;
 
-        std::string returnValueStr_{};  // empty = no return value, otherwise it contains ". rv = X"
+        // Full state. The fast path leaves it uninitialized, so it is valid only
+        // if the sentry is not dormant (set by init() or wake())
+        // Enter/leave lines are turned on by the call site (see forceSite())
+        bool forcedBorders_;
+        void* relatedObj_;
+        std::int64_t startTime_;    // steady clock (ns) when Timer or Stats flag is turned on
+        std::int64_t traceStart_;   // if not 0 - start of the trace span (see "debuglog_trace.h")
+        // Rarely used state (owned, deleted by leave())
+        struct Extra
+        {
+            std::string traceArgs;          // enter message for the trace span
+            std::string returnValueStr;     // empty = no return value, otherwise it contains ". rv = X"
+        };
+        Extra* extra_;
+        Extra& getExtra();
+        // Reset the full state of just created or woken sentry
+        void initFullState();
+
+        // Sentry with any of these flags is never dormant
+        static constexpr Flags kActiveFlags =
+            static_cast<Flags>(static_cast<EnumType_t>(Flags::Force)
+                               | static_cast<EnumType_t>(Flags::AppendContextName)
+                               | static_cast<EnumType_t>(Flags::Timer)
+                               | static_cast<EnumType_t>(Flags::Stats)
+                               | static_cast<EnumType_t>(Flags::TailBuffer));
 
     private:
         // aux class for private ctor
@@ -291,6 +622,9 @@ class SentryLogger
         //Special ctor for root node
         SentryLogger(RootTag);
 
+        // Upper level sentry in the stack of current thread (nullptr for root)
+        SentryLogger* getParent() const;
+
 };
         
 /**
@@ -308,6 +642,7 @@ public:
     void printStackTrace();
     void printStackTrace(StackTraceArgs args, Level level = Level::This);
     void print(std::string_view content = "");
+    void printDeferred(async::RenderFn render, async::FillFn fill, const void* context);
     bool isAllowed(SentryLogger::Stage stage) const
     {
         return SentryLogger::getLast()->isAllowed(stage);
@@ -324,6 +659,14 @@ public:
     {
         return SentryLogger::getLast()->isAllowedAndSetTempLevel(stage, level);
     }
+    bool isSiteAllowedAndSetTempLevel(sites::Site& site, const char* function, SentryLogger::Stage stage)
+    {
+        return SentryLogger::getLast()->isSiteAllowedAndSetTempLevel(site, function, stage);
+    }
+    bool isSiteAllowedAndSetTempLevel(sites::Site& site, const char* function, SentryLogger::Stage stage, Level level)
+    {
+        return SentryLogger::getLast()->isSiteAllowedAndSetTempLevel(site, function, stage, level);
+    }
 
 // TODO: for objlog.c
     void write(SentryLogger::Kind kind,
@@ -335,7 +678,7 @@ public:
                std::string_view streamBody);
 
 private:
-    const std::string& getContextName();
+    std::string_view getContextName();
 };
 
 struct StackTraceArgs
@@ -405,8 +748,35 @@ inline SentryLogger::EnumType_t operator|(const SentryLogger::Flags v1,
      if (false) [[maybe_unused]] SentryLoggerStub SENTRYLOGGER_ENTER_0
 // Arguments: pretty, context[, arg]
 #define SENTRYLOGGER_CREATE_1(...) using namespace ::tsv::debuglog; [[maybe_unused]] SentryLogger sentryLogger{__VA_ARGS__}; \
+     sentryLogger.applySite(SENTRYLOGGER_SITE(), __PRETTY_FUNCTION__); \
+     if (sentryLogger.isAllowed(SentryLogger::Stage::Enter)) SentryLogger::EnterHelper SENTRYLOGGER_ENTER_1
+#define SENTRYLOGGER_PRINT(...) if (sentryLogger.isSiteAllowedAndSetTempLevel(SENTRYLOGGER_SITE(), __PRETTY_FUNCTION__, \
+            SentryLogger::Stage::Event __VA_W_COMMA(__VA_ARGS__))) sentryLogger.print
+// Static runtime state of the call site (see "debuglog_sites.h")
+#define SENTRYLOGGER_SITE() []() -> ::tsv::debuglog::sites::Site& { \
+            static ::tsv::debuglog::sites::Site site{__FILE__, __LINE__}; \
+            return site; }()
+// Static state of the throttled call site
+#define SENTRYLOGGER_THROTTLE_SITE(spec) []() -> ::tsv::debuglog::throttle::Site& { \
+            static ::tsv::debuglog::throttle::Site site{::tsv::debuglog::throttle::spec, __FILE__, __LINE__}; \
+            return site; }()
+#define SENTRYLOGGER_PRINT_THROTTLED(spec) if (sentryLogger.isSiteAllowedAndSetTempLevel(SENTRYLOGGER_SITE(), __PRETTY_FUNCTION__, \
+            SentryLogger::Stage::Event) \
+            && SENTRYLOGGER_THROTTLE_SITE(spec).pass(sentryLogger)) sentryLogger.print
+#define SENTRYLOGGER_CREATE_THROTTLED(spec, ...) using namespace ::tsv::debuglog; [[maybe_unused]] SentryLogger sentryLogger{__VA_ARGS__}; \
+     sentryLogger.applySite(SENTRYLOGGER_SITE(), __PRETTY_FUNCTION__); \
+     if (sentryLogger.isScopeAllowed() && !SentryLogger::isSubtreeSuppressed() \
+         && !SENTRYLOGGER_THROTTLE_SITE(spec).pass(sentryLogger)) \
+         sentryLogger.suppressSubtree(); \
      if (sentryLogger.isAllowed(SentryLogger::Stage::Enter)) SentryLogger::EnterHelper SENTRYLOGGER_ENTER_1
-#define SENTRYLOGGER_PRINT(...) if (sentryLogger.isAllowedAndSetTempLevel(SentryLogger::Stage::Event __VA_W_COMMA(__VA_ARGS__))) sentryLogger.print
+// Arguments: fmtStr[, args]
+#define SENTRYLOGGER_PRINT_DEFERRED(fmtStr, ...) if (sentryLogger.isSiteAllowedAndSetTempLevel(SENTRYLOGGER_SITE(), __PRETTY_FUNCTION__, \
+            SentryLogger::Stage::Event)) \
+     ::tsv::debuglog::deferred::print(sentryLogger, \
+        []() -> const ::tsv::debuglog::deferred::Site& { \
+            static constexpr ::tsv::util::tostr::ArgName names[] = { MACRO_TOSTR__ARG_NAMES(__VA_ARGS__) }; \
+            static constexpr ::tsv::debuglog::deferred::Site site{fmtStr, names, __FILE__, __LINE__}; \
+            return site; }() __VA_W_COMMA(__VA_ARGS__))
 
 #else
 
@@ -422,5 +792,8 @@ static_assert(false,"stop2");
 #define SENTRYLOGGER_CREATE_0(...)  if (false) SentryLoggerStub SENTRYLOGGER_ENTER_0
 #define SENTRYLOGGER_CREATE_1(...)  if (false) SentryLoggerStub SENTRYLOGGER_ENTER_0
 #define SENTRYLOGGER_PRINT(...)     SENTRYLOGGER_DO_NOTHING_STANDALONE
+#define SENTRYLOGGER_PRINT_DEFERRED(...) SENTRYLOGGER_DO_NOTHING_STANDALONE()
+#define SENTRYLOGGER_PRINT_THROTTLED(...) SENTRYLOGGER_DO_NOTHING_STANDALONE
+#define SENTRYLOGGER_CREATE_THROTTLED(spec, ...) SENTRYLOGGER_CREATE_1(__VA_ARGS__)
 
 #endif
@@ -0,0 +1,65 @@
+#pragma once
+
+/**
+  Purpose: Flight recorder - keep the recent suppressed lines in memory and print them on incident
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Lines which are less important than Settings::getLogLevel(), but not less than
+  Settings::getCaptureLogLevel() are not passed to the output handler. Instead they are copied into
+  the fixed-size per-thread ring (the oldest record is overwritten). Capture is a lock-free memcpy.
+  The last records of all threads are printed by dump(), which is called automatically
+  by the Error/Fatal line or on the next line after the requested signal.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "debuglog_enum.h"
+
+namespace tsv::debuglog::recorder
+{
+
+struct Args
+{
+    std::size_t recordsPerThread = 512;     // capacity of each ring (applied to the rings created later)
+    std::size_t dumpRecords = 256;          // how many of the last records are printed by dump()
+    bool dumpOnError = true;                // dump() before output of Error or Fatal line
+};
+
+void configure(const Args& args);
+Args getArgs();
+
+// Print the last `count` (0 = Args::dumpRecords) captured and not yet dumped records of all threads
+// in order of time. Return number of printed records.
+std::size_t dump(std::size_t count = 0);
+
+// Async-signal-safe request to dump(). It is done by the next logged line of any thread or by dumpIfRequested().
+void requestDump();
+// Install handler of the signal which calls requestDump()
+bool installSignalHandler(int signo);
+
+namespace impl
+{
+extern std::atomic<bool> requested_s;
+
+// Copy the line into the ring of the current thread
+void capture(sentry_enum::Level level,
+             sentry_enum::Kind kind,
+             char nestedSym,
+             int depth,
+             std::string_view contextName,
+             std::string_view prefix,
+             std::string_view body,
+             std::string_view suffix);
+}  // namespace impl
+
+inline void dumpIfRequested()
+{
+    if (impl::requested_s.load(std::memory_order_relaxed) && impl::requested_s.exchange(false))
+        dump();
+}
+
+}  // namespace tsv::debuglog::recorder
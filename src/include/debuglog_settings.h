@@ -13,6 +13,8 @@
 
 #if DEBUG_LOGGING
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace tsv::debuglog 
@@ -47,7 +49,8 @@ public:
             SetLogLevel,
             SetDefaultLogLevel,
             SetWatchLogLevel,
-            SetEnableStacktraceFlag
+            SetEnableStacktraceFlag,
+            SetCaptureLogLevel
         };
         struct EnableStackTraceTag {};
 
@@ -75,72 +78,139 @@ public:
         std::vector<Operation> operations_;
     };
 
-    // Batch settings applying
+    // Parts of the output line (see setLineLayout())
+    enum class LineField : std::uint8_t
+    {
+        Prefix,         // setLoggerPrefix()
+        Timestamp,      // local time "HH:MM:SS.uuuuuu "
+        ThreadId,       // system thread id "[tid] "
+        ThreadName,     // "[name] " of the thread (taken on its first printed line)
+        Level,          // "INFO " and so on
+        Kind,           // name given by setKindNames() (if printKindFlag)
+        Nested,         // nesting level and markers (if isNestedLevelMode)
+        Context,        // "{contextName}" (empty braces if printContextFlag is false)
+        Body            // text of the line
+    };
+
+    // Step of the compiled line layout. Constant parts are merged into the Prefix step with given text.
+    struct LineOp
+    {
+        LineField field;
+        std::string text;
+    };
+
+    /**
+     * Immutable state of the settings.
+     * Each change makes a modified copy and publishes it with atomic swap, so readers never take a lock
+     * and never see a half-applied batch. Old snapshots are destroyed when no Reader could refer to them.
+     */
+    struct Snapshot
+    {
+        Level logLevel = Level::Info;                 // lines with less important level than this are ignored
+        Level defaultSentryLoggerLevel = Level::Info;  // real level of SentryLogger::Level::Default value
+        Level watchLogLevel = Level::Default;
+        Level captureLogLevel = Level::Off;           // lines down to this level are kept by the flight recorder
+        bool stackTraceEnabled = true;                // only if true, printStacktrace() do its job
+        bool isNestedLevelMode = true;                // if true, then align by/display depth of sentries nesting level
+        bool printContextFlag = true;                 // if true, print name of context for each output line
+        bool printKindFlag = true;                    // if true, print name of kind
+        OutputHandler outputHandler = nullptr;        // handler which actually do output of prepared by logger lines
+        std::string loggerPrefix;                     // string which added into beginning of each logger output line
+        // Reverse ordered vector of namespace prefixes which are removed
+        // from auto-generated context names. The only first found is cuted.
+        std::vector<std::string> cutoffNamespaces;
+        std::vector<int> kindsState;                  // state of each kind (default everything is turned off)
+        std::vector<std::string> kindNames;           // prefixes which are printed for each kind
+        std::vector<LineField> lineLayout{LineField::Prefix, LineField::Nested, LineField::Kind,
+                                          LineField::Context, LineField::Body};
+        std::vector<LineOp> lineOps;                  // lineLayout compiled with the values above
+    };
+
+    // RAII access to the current snapshot. Keep it only for short time, because it delays reclamation.
+    class Reader
+    {
+    public:
+        Reader();
+        ~Reader();
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const Snapshot* operator->() const { return snapshot_; }
+        const Snapshot& operator*() const { return *snapshot_; }
+
+    private:
+        const Snapshot* snapshot_;
+    };
+
+    // Batch settings applying. The whole batch is published at once.
     static void set( std::vector<Operation> ops );
 
     // todo: not flag but level + system log level
-    static bool isKindAllowed(SentryLogger::Kind kind);
+    static bool isKindAllowed(SentryLogger::Kind kind)
+    {
+        return SentryLogger::enablement_s.isKindAllowed(kind);
+    }
     static int getLoggerKindState(SentryLogger::Kind kind);
-    static SentryLogger::Level getLoggerKindStateAsLevel(SentryLogger::Kind kind);
+    static SentryLogger::Level getLoggerKindStateAsLevel(SentryLogger::Kind kind)
+    {
+        return SentryLogger::enablement_s.getKindStateAsLevel(kind);
+    }
     static void setLoggerKindState(SentryLogger::Kind kind, bool enableFlag = true);
     static void setLoggerKindState(SentryLogger::Kind kind, int value);
     static void setLoggerKindState(SentryLogger::Kind kind, SentryLogger::Level value);
 
-    static auto getLogLevel() { return logLevel_s; }
-    static auto getWatchLogLevel() { return watchLogLevel_s; }
-    static bool isStacktraceEnabled() { return stackTraceEnabled_s; }
+    static Level getLogLevel() { return SentryLogger::enablement_s.getLogLevel(); }
+    static Level getWatchLogLevel();
+    static bool isStacktraceEnabled();
 
     static void setLogLevel(SentryLogger::Level level);
+    // Lines which are less important than the log level, but not than this, go to the flight recorder
+    // instead of the output (see "debuglog_recorder.h"). Level::Off turns it off.
+    static Level getCaptureLogLevel();
+    static void setCaptureLogLevel(SentryLogger::Level level);
     static void setWatchLogLevel(SentryLogger::Level level);
     static void enableStacktrace(bool flag = true);
 
-    static bool getPrintContextFlag() { return printContextFlag_s; }
+    static bool getPrintContextFlag();
     static void setPrintContextFlag(bool flag);
 
-    static SentryLogger::Level getDefaultLevel();
+    static SentryLogger::Level getDefaultLevel() { return SentryLogger::enablement_s.getDefaultLevel(); }
     static void setDefaultLogLevel(SentryLogger::Level level);
 
     static void setOutputHandler(OutputHandler handler);
     static void setLoggerPrefix(std::string_view prefix);
 
-    static std::vector<std::string>& cutoffNamespaces();
+    // Which parts and in which order make the output line (default: Prefix, Nested, Kind, Context, Body)
+    static std::vector<LineField> getLineLayout();
+    static void setLineLayout(std::vector<LineField> layout);
+
+    static std::vector<std::string> cutoffNamespaces();
     static void setCutoffNamespaces(std::vector<std::string> arr);
 
-    // Initialize kind->name map used for output if printKindFlag_s==true
+    // Initialize kind->name map used for output if printKindFlag is true
     static void setKindNames(const std::vector<KindNamePair>& names);
 
     // for unittest
     static void setNestedLevelFlag(bool flag);
 
 private:
-    // if true, then align by/display depth of sentries nesting level
-    static bool isNestedLevelMode_s;
-    // if true, print name of context for each output line
-    static bool printContextFlag_s;
-    // @todo -- what I expect to do here?
-    static bool printContextName_s;
-    // if true, print name of kind
-    static bool printKindFlag_s;
-    // string which added into beginning of each logger output line
-    static std::string loggerPrefix_s;
-    // lines with less important level than this are ignored
-    static SentryLogger::Level logLevel_s;
-    // real level of SentryLogger::Level::Default value
-    static SentryLogger::Level defaultSentryLoggerLevel_s;
-    //
-    static SentryLogger::Level watchLogLevel_s;
-    // only if true, printStacktrace() do its job
-    static bool stackTraceEnabled_s;
-    // handler which actually do output of prepared by logger lines
-    static OutputHandler outputHandler_s;
-
-    // Reverse ordered vector of namespace prefixes which are removed
-    // from auto-generated context names. The only first found is cuted.
-    static std::vector<std::string> cutoffNamespaces_s;
-
-    // instance of the kind flags array
-    // (function to controllable lifetime and init time)
-    static int* getKindsStateArray();
+    // Apply operation to the snapshot which is not published yet
+    static void apply(Snapshot& snapshot, const Operation& op);
+    static void applyKindState(Snapshot& snapshot, SentryLogger::Kind kind, int value);
+    // Copy values of the snapshot which is going to be published to SentryLogger::enablement_s
+    static void refreshEnablementTable(const Snapshot& snapshot);
+    // Append the line formatted by snapshot.lineOps to the `out`
+    static void formatLine(std::string& out,
+                           const Snapshot& snapshot,
+                           const SentryLogger::LineInfo& info,
+                           std::string_view contextName,
+                           std::string_view prefix,
+                           std::string_view body,
+                           std::string_view suffix);
+
+    // Make a copy of the current snapshot, change it with modify(Snapshot&) and publish
+    template <typename Fn>
+    static void update(Fn&& modify);
 };
 
 } // namespace tsv::debuglog
@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+  Purpose: Process-wide state of the library modules
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Sentries could be created and printed from destructors of other statics and thread_local objects,
+  so the state they use is created on the first use and is never destroyed.
+
+  Such singletons guard their members by own mutex_. Private helpers named *Locked()
+  expect the caller to hold it.
+*/
+
+namespace tsv::debuglog::impl
+{
+
+// The instance of T created on the first call and leaked on purpose (see above)
+template <typename T>
+T& leakedSingleton()
+{
+    static auto* instance = new T;
+    return *instance;
+}
+
+}  // namespace tsv::debuglog::impl
@@ -0,0 +1,100 @@
+#pragma once
+
+/**
+  Purpose: Registry of SENTRY_* / SAY_* call sites with runtime per-site switches
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Each macro expansion owns constant-initialized static site (no static-init cost)
+  with one byte of the runtime state. Site is linked to the registry on its first execution
+  and gets state from the rules given by set(). After that the check is a single byte load.
+  Rules are kept, so they are applied to the sites which are executed later.
+*/
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "debuglog_enum.h"
+
+namespace tsv::debuglog::sites
+{
+
+enum class State : std::uint8_t
+{
+    Unknown,    // not registered yet
+    Default,    // filtered by level and kind as usual
+    Off,        // never printed
+    On          // printed regardless of kind and suppressed stages, level is cut to the global log level
+                // (for the sentry - only its enter/leave lines)
+};
+
+class Site
+{
+public:
+    constexpr Site(const char* file, int line)
+        : file_(file), line_(line)
+    {}
+
+    Site(const Site&) = delete;
+    Site& operator=(const Site&) = delete;
+
+    // function - __PRETTY_FUNCTION__ of the call site, kind - kind of the logger (used only on registration)
+    State getState(const char* function, sentry_enum::Kind kind)
+    {
+        auto state = state_.load(std::memory_order_relaxed);
+        if (state != State::Unknown)
+            return state;
+        return registerSite(function, kind);
+    }
+
+    const char* getFile() const { return file_; }
+    int getLine() const { return line_; }
+    const char* getFunction() const { return function_; }
+    sentry_enum::Kind getKind() const { return kind_; }
+
+private:
+    friend class Registry;
+    State registerSite(const char* function, sentry_enum::Kind kind);
+
+    std::atomic<State> state_{State::Unknown};
+    const char* file_;
+    int line_;
+    // Filled on registration
+    const char* function_ = nullptr;
+    sentry_enum::Kind kind_{};
+    Site* next_ = nullptr;
+};
+
+// Site matches if all conditions are true. Globs are in fnmatch() syntax.
+struct Filter
+{
+    std::string file = "*";         // full path as given by __FILE__
+    std::string function = "*";     // function name without return type and arguments ("ns::Class::method")
+    int firstLine = 0;
+    int lastLine = INT_MAX;
+};
+
+struct SiteInfo
+{
+    std::string file;
+    std::string function;
+    int line;
+    sentry_enum::Kind kind;
+    State state;
+};
+
+// Add rule and apply it to registered sites. Last matched rule wins, State::Default cancels previous ones.
+// Return number of matched registered sites
+std::size_t set(const Filter& filter, State state);
+
+// Drop all rules and return all sites to State::Default
+void reset();
+
+// Registered (executed at least once) sites
+std::vector<SiteInfo> list();
+
+}  // namespace tsv::debuglog::sites
@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+  Purpose: Aggregated timing statistics of sentry scopes
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Sentry with SentryLogger::Flags::Stats doesn't print the processing time, but adds the duration
+  of the scope to the statistics of its context: count, sum, min, max and log-bucketed histogram.
+  Each thread collects its own shard without contention, shards are merged on demand.
+*/
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "debuglog_enum.h"
+
+namespace tsv::debuglog::stats
+{
+
+// Merged statistics of one context. All durations are in nanoseconds
+struct Summary
+{
+    std::string name;
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t min = 0;
+    std::uint64_t max = 0;
+    // Quantiles are upper bounds of histogram buckets (relative error is less than 1/16)
+    std::uint64_t p50 = 0;
+    std::uint64_t p90 = 0;
+    std::uint64_t p99 = 0;
+    std::uint64_t p999 = 0;
+};
+
+// Add sample of duration for the context name (call it for custom measurements)
+void record(std::string_view name, std::uint64_t ns);
+
+// Same as record(), but name of the context is evaluated by getName(site) only for the first sample
+// of the site in the thread. Site should be the pointer to static data (like __PRETTY_FUNCTION__)
+typedef std::string (*NameFn)(const void* site);
+void recordSite(const void* site, NameFn getName, std::uint64_t ns);
+
+// Merge shards of all threads. Result is sorted by name
+std::vector<Summary> collect();
+
+// Print merged statistics through the output handler, one line per context
+void dump(sentry_enum::Level level = sentry_enum::Level::Info);
+
+// Write merged statistics in OpenMetrics text format. Return false if the file can't be written
+bool writeOpenMetrics(const std::string& path);
+
+// Forget all collected samples
+void reset();
+
+}  // namespace tsv::debuglog::stats
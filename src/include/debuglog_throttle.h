@@ -0,0 +1,107 @@
+#pragma once
+
+/**
+  Purpose: Per-call-site throttling of SAY_*_THROTTLED / SENTRY_*_THROTTLED
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Each call site has its own static lock-free state. The check is done after the check of
+  level and kind, but before the formatting of arguments, so suppressed call costs
+  one atomic operation. Amount of suppressed messages is reported with the next passed one.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "debuglog_enum.h"
+
+namespace tsv::debuglog::throttle
+{
+
+enum class Mode
+{
+    EveryN,     // pass 1st, (N+1)th, (2N+1)th, ... calls
+    FirstN,     // pass only first N calls
+    PerSecond   // pass at most N calls per second (GCRA, burst up to N)
+};
+
+struct Spec
+{
+    Mode mode;
+    std::uint64_t n;
+};
+
+constexpr Spec everyN(std::uint64_t n) { return {Mode::EveryN, n ? n : 1}; }
+constexpr Spec firstN(std::uint64_t n) { return {Mode::FirstN, n}; }
+constexpr Spec perSecond(std::uint64_t n) { return {Mode::PerSecond, n ? n : 1}; }
+
+class Site
+{
+public:
+    constexpr Site(Spec spec, const char* file, int line)
+        : spec_(spec), file_(file), line_(line)
+    {}
+
+    Site(const Site&) = delete;
+    Site& operator=(const Site&) = delete;
+
+    bool allow()
+    {
+        switch (spec_.mode)
+        {
+            case Mode::EveryN:
+                return counter_.fetch_add(1, std::memory_order_relaxed) % spec_.n == 0;
+            case Mode::FirstN:
+                // Do not touch the counter anymore to avoid its overflow and cache line bouncing
+                return counter_.load(std::memory_order_relaxed) < spec_.n
+                       && counter_.fetch_add(1, std::memory_order_relaxed) < spec_.n;
+            case Mode::PerSecond:
+                return allowRate();
+        }
+        return true;
+    }
+
+    // Check the throttle and report previously suppressed messages through the logger
+    template <typename Logger>
+    bool pass(Logger& logger)
+    {
+        if (!allow())
+        {
+            suppress();
+            return false;
+        }
+        if (suppressed_.load(std::memory_order_relaxed))
+        {
+            auto count = suppressed_.exchange(0, std::memory_order_relaxed);
+            if (count)
+                logger.print(summary(count));
+        }
+        return true;
+    }
+
+    std::uint64_t takeSuppressed() { return suppressed_.exchange(0, std::memory_order_relaxed); }
+    std::string getLocation() const;
+
+    // Sites which have suppressed something are linked to the global list
+    Site* getNext() const { return next_; }
+
+private:
+    bool allowRate();
+    void suppress();
+    static std::string summary(std::uint64_t count);
+
+    Spec spec_;
+    const char* file_;
+    int line_;
+    std::atomic<std::uint64_t> counter_{0};     // number of calls or theoretical arrival time (ns) for PerSecond
+    std::atomic<std::uint64_t> suppressed_{0};
+    std::atomic<bool> registered_{false};
+    Site* next_ = nullptr;
+};
+
+// Report through the output handler amount of suppressed messages for each site which have them
+// (e.g. for FirstN sites, which never pass anything more)
+void dumpSuppressed(sentry_enum::Level level = sentry_enum::Level::Warning);
+
+}  // namespace tsv::debuglog::throttle
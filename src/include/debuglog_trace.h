@@ -0,0 +1,61 @@
+#pragma once
+
+/**
+  Purpose: Export of sentries as Chrome Trace Event Format (chrome://tracing, Perfetto)
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  While the trace is active, each allowed sentry produces complete ("X") event on leave
+  with its enter message as args, and each SAY_* line produces instant ("i") event.
+  Events are collected in per-thread buffers which are written to the file by large chunks,
+  so memory is bounded by the chunk size per thread.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tsv::debuglog::trace
+{
+
+struct Args
+{
+    std::size_t chunkSize = 64 * 1024;   // per-thread buffer is written to the file when exceeds this size
+};
+
+// Start writing of the trace into the file. Return false if already started or file can't be opened
+bool start(const std::string& path, Args args = {});
+
+// Write buffers of all threads and close the file. Called automatically at exit.
+void stop();
+
+// Write buffers of all threads to the file
+void flush();
+
+namespace impl
+{
+extern std::atomic<bool> active_s;
+}
+
+inline bool isActive()
+{
+    return impl::active_s.load(std::memory_order_relaxed);
+}
+
+// Monotonic timestamp in ns (same clock as used by events)
+std::int64_t now();
+
+// Span of the sentry scope
+void complete(std::string_view name,
+              std::int64_t startNs,
+              std::int64_t finishNs,
+              std::string_view enterArgs,
+              std::string_view returnValue);
+
+// Single line logged inside of the context
+void instant(std::string_view body, std::string_view context);
+
+}  // namespace tsv::debuglog::trace
@@ -13,8 +13,9 @@
 namespace tsv::debuglog
 {
 
-    // Transform type and function names to pretty form
-    std::string demangle(const char* name);
+    // Transform type and function names to pretty form.
+    // Result is cached for the lifetime of the process.
+    const std::string& demangle(const char* name);
 
     // Resolve pointer "addr" to function name
     //  if addLineNum = true, then include "at file:lineno"
@@ -41,6 +42,10 @@ namespace tsv::debuglog
         extern bool btShortList;      // if true, remember already printed stacktraces and just say it's number on repeat
         extern bool btShortListOnly;  // if true, do not print full stack - only short line
         extern int  btNumHeadFuncs;  // how many first functions include into collapsed stacktrace
+        extern bool btUseSymbolizer;  // if true, resolve function names and lines by in-process symbolizer (see debugsymbols.h)
+        extern int  btResolverWorkers; // max number of addr2line processes (read on the first use of addr2line)
+        extern bool btPersistentCache; // if true, keep answers of addr2line on disk between runs (see debugsymcache.h)
+        extern std::string btCacheDir; // directory of persistent cache (if empty - $XDG_CACHE_HOME/debuglog)
     }
 
 }  // namespace tsv::debuglog
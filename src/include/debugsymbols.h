@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+  Purpose: In-process symbolizer - resolve code address to function name by ELF symbol tables
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  The executable and shared objects loaded at the moment (see dl_iterate_phdr) are mapped into
+  memory once. Function symbols of their .symtab/.dynsym are collected into one index sorted
+  by address (Eytzinger layout), so lookup is a cache-friendly binary search without syscalls.
+  Modules opened later by dlopen() are picked up on the lookup of their address (the index is
+  rebuilt if the loader reports added or removed modules), or explicitly by reload().
+  Addresses outside of all modules (JIT code) are looked up in /tmp/perf-<pid>.map.
+
+  File and line are taken from DWARF .debug_line of the module (see debugdwarf.h), which is
+  parsed on the first request. Compressed debug sections and separate debug files are not
+  supported - resolveAddr2Name() falls back to addr2line for them.
+*/
+
+#include <cstddef>
+#include <string_view>
+
+namespace tsv::debuglog::symbols
+{
+
+struct Symbol
+{
+    const char* name = nullptr;     // mangled name (valid till the end of the process)
+    const void* start = nullptr;    // address of the function
+    std::size_t size = 0;
+    const char* module = nullptr;   // path of the executable or the shared object
+};
+
+struct Module
+{
+    const char* path = nullptr;     // path of the executable or the shared object
+    const void* base = nullptr;     // load base (addresses in the file are relative to it)
+    std::string_view buildId;       // hex of GNU build-id note (empty if absent)
+};
+
+// Find the function which contains `addr`. Return false if it is unknown.
+bool lookup(const void* addr, Symbol& symbol);
+
+// Demangled name of the function which contains `addr` (empty if it is unknown)
+std::string_view functionName(const void* addr);
+
+// Source file and line of the instruction at `addr`. Return false if there is no line info.
+// The file name is valid till the end of the process.
+bool lookupLine(const void* addr, std::string_view& file, int& line);
+
+// Find the loaded module which contains `addr`. Return false if it is unknown.
+bool findModule(const void* addr, Module& module);
+
+// Rescan the loaded modules
+void reload();
+
+}  // namespace tsv::debuglog::symbols
@@ -0,0 +1,45 @@
+#pragma once
+
+/**
+  Purpose: Persistent cache of resolved symbols - keyed by build-id of the module and offset in it
+  Author: Taranenko Sergey
+  Date: 17-Oct-2026
+  License: BSD. See License.txt
+
+  Answers of addr2line are slow to get (and symbolizer parses DWARF of each module at the first
+  lookup), so they could be kept between runs of the same binary. The resolver asks the cache first.
+  Each module has its own file <directory()>/<build-id>.symcache with records sorted by offset
+  (see debugsymcache.cpp). The file is mapped on the first lookup of address of that module,
+  new entries are written by flush() into the new file which replaces the old one. Several processes
+  could share the directory: flush() merges new entries with the current file under the lock.
+  The resolver calls flushPeriodically(), and the rest is flushed at exit.
+  Modules without build-id are not cached.
+
+  Used by resolveAddr2Name() and getStackTrace() if resolve::settings::btPersistentCache is true.
+*/
+
+#include <string>
+#include <string_view>
+
+namespace tsv::debuglog::symcache
+{
+
+// Find cached function name and " at file:line" suffix for the code address
+bool find(const void* addr, std::string& funcName, std::string& path);
+
+// Remember resolved address (stored to disk by flush())
+void store(const void* addr, std::string_view funcName, std::string_view path);
+
+// Write new entries to disk
+void flush();
+
+// Same, but only if the last flush was long enough ago
+void flushPeriodically();
+
+// Forget loaded and not flushed entries (the next find() reads the files again)
+void reset();
+
+// resolve::settings::btCacheDir if set, otherwise $XDG_CACHE_HOME/debuglog or $HOME/.cache/debuglog
+std::string directory();
+
+}  // namespace tsv::debuglog::symcache
@@ -7,7 +7,8 @@
   License: BSD. See License.txt
 */
 
-#include <vector>
+#include <cstddef>
+#include <string_view>
 #include "tostr_handler.h"
 
 // make possible macros overriding
@@ -22,18 +23,18 @@
 // Print to string list of arguments with their names
 //   Example:  std::cout << TOSTR_ARGS( str_var, " abc", 3, !func(arg) ) << "\n";
 //   Output:   strvar = "VALUE1" abc, 3 = 3, !func(arg) = VALUE2
-#define TOSTR_ARGS(...) ::tsv::util::tostr::Printer( ::tsv::util::tostr::Mode::Args, { MACRO_TOSTR__EXPAND_EACH_VAL(__VA_ARGS__) } ).do_print( __VA_ARGS__ )
+#define TOSTR_ARGS(...) ::tsv::util::tostr::Printer( ::tsv::util::tostr::Mode::Args, MACRO_TOSTR__ARG_TABLE(__VA_ARGS__) ).do_print( __VA_ARGS__ )
 
 // Print to string converted concatenation of all given values ( implicitly converted to string using toStr() )
 //   Example:  std::cout << TOSTR_JOIN( str_var, " abc", 3, !func(arg) ) << "\n";
 //   Output:   VALUE1 abc3VALUE2
-#define TOSTR_JOIN(...) ::tsv::util::tostr::Printer( ::tsv::util::tostr::Mode::Join, {} ).do_print( __VA_ARGS__ )
+#define TOSTR_JOIN(...) ::tsv::util::tostr::Printer<0>( ::tsv::util::tostr::Mode::Join, nullptr ).do_print( __VA_ARGS__ )
 
 // Combination of TOSTR_ARGS() and TOSTR_JOIN() - use literals/arithmetical as is, but name_of_var with its value for vars/calls/..
 // Use it for quickly represent simple formulas
 //   Example:  std::cout << TOSTR_EXPR( res, "=", 3, "+", !func(arg) ) << "\n";
 //   Output:  res{VALUE_RES} = 3 + !func(arg){RETURN_VALUE_OF_CALL}
-#define TOSTR_EXPR(...) ::tsv::util::tostr::Printer( ::tsv::util::tostr::Mode::Expr, { MACRO_TOSTR__EXPAND_EACH_VAL(__VA_ARGS__) } ).do_print( __VA_ARGS__ )
+#define TOSTR_EXPR(...) ::tsv::util::tostr::Printer( ::tsv::util::tostr::Mode::Expr, MACRO_TOSTR__ARG_TABLE(__VA_ARGS__) ).do_print( __VA_ARGS__ )
 
 #if __has_include(<fmt/format.h>)
 #define TOSTR_FMT(...) fmt::format( __VA_ARGS__ )
@@ -48,6 +49,9 @@
 
 /************************* Implementation ***********************************/
 
+#define MACRO_TOSTR__STRINGIZE_IMPL(x) #x
+#define MACRO_TOSTR__STRINGIZE(x) MACRO_TOSTR__STRINGIZE_IMPL(x)
+
 namespace tsv::util::tostr
 {
 
@@ -64,11 +68,55 @@ enum Details : short {
         Extended
      }; 
 
+// Stringized argument of TOSTR_ARGS/TOSTR_EXPR with its compile-time classification
+struct ArgName
+{
+    enum Flags : unsigned char {
+        Variable = 0,
+        AsIs = 1,       // literal, number or result of nested TOSTR_*: printed as is, without name
+        Quoted = 2      // string literal: followed by " " instead of ", "
+    };
+
+    const char* name;
+    unsigned char flags;
+};
+
+namespace impl
+{
+constexpr bool startsWith(std::string_view base, std::string_view lookup)
+{
+    return ( base.size() >= lookup.size() ) && (base.substr(0,lookup.size()) == lookup );
+}
+
+// Beginning of TOSTR_* expansion (up to the template or call bracket)
+constexpr std::string_view nestedPrinterPrefix()
+{
+    std::string_view base = MACRO_TOSTR__STRINGIZE(TOSTR_JOIN());
+    return base.substr(0, base.find_first_of("<("));
+}
+}  // namespace impl
+
+// Detect by #arg if argument is a literal/number (first symbol) or result of nested TOSTR_* macro
+constexpr ArgName classifyArg(const char* name)
+{
+    std::string_view base = name;
+    char first = base.empty() ? '\0' : base[0];
+    if (first == '"')
+        return { name, static_cast<unsigned char>(ArgName::AsIs | ArgName::Quoted) };
+    if (first == '\'' || ( first >= '0' && first <= '9' )
+        || impl::startsWith(base, impl::nestedPrinterPrefix())
+        || impl::startsWith(base, "fmt::format(") || impl::startsWith(base, "std::format("))
+        return { name, ArgName::AsIs };
+    return { name, ArgName::Variable };
+}
+
+// N - number of known argument names (arguments after them are processed as variables without name)
+template<std::size_t N>
 class Printer
 {
 public:
 
-    std::vector<const char*> names_;  // List of variable names (used for Mode::Args, Mode::Expr)
+    const ArgName* names_;            // Table of argument names (used for Mode::Args, Mode::Expr)
     Mode mode_;                       // Printing mode
     Details detailed_ = Details::Normal;
     bool joinOnce_ = false;
@@ -76,7 +124,7 @@ public:
     std::size_t index_;               // current index of argument
     std::string acc_str_;             // string which accumulate output of do_print()
 
-    Printer( Mode mode, std::vector<const char*> names )
+    Printer( Mode mode, const ArgName* names )
          : names_( names ), mode_( mode )
      {
      }
@@ -85,13 +133,15 @@ public:
      std::string do_print( StrTail&&... tail )
     {
         index_ = 0;
-        acc_str_ = "";
+        acc_str_.clear();
         return print( std::forward<StrTail>( tail )... );
     }
 
 private:
-    // return true if argument is result of nested TOSTR_* macro
-    static bool detectNested(std::string_view base);
+    unsigned char flagsAt( std::size_t index ) const
+    {
+        return index < N ? names_[index].flags : static_cast<unsigned char>(ArgName::Variable);
+    }
 
     // Final print
     std::string print()
@@ -133,41 +183,20 @@ private:
         // 1. Tune output format + print separator if needed
         if (mode_ == Mode::Args && !joinOnce_)
         {
-            if (index_ >= names_.size())
-            {
-                asisFlag = false;
-            }
-            else
-            {
-                char first = names_[index_][0];     // first symbol of #arg (detect literals and numbers)
-                asisFlag = (first == '"' || first=='\'' || ( first >= '0' && first <= '9' )
-                            || detectNested(names_[index_]));
-                excludeName = asisFlag;
-            }
+            asisFlag = (flagsAt(index_) & ArgName::AsIs);
+            excludeName = asisFlag || index_ >= N;
 
             // add separator
             if (!asisFlag && !acc_str_.empty())
-            {
-                char prev = names_[index_-1][0];
-                acc_str_ += ( prev != '"' ? ", " : " " );
-            }
+                acc_str_ += ( (flagsAt(index_-1) & ArgName::Quoted) ? " " : ", " );
 
             modeToStr = ( detailed_==Details::Normal  ? ENUM_TOSTR_REPR : 
                           (detailed_==Details::NormalHex ? ENUM_TOSTR_REPR_HEX : ENUM_TOSTR_EXTENDED) );
         }
         else if (mode_ == Mode::Expr && !joinOnce_)
         {
-            if (index_ >= names_.size())
-            {
-                asisFlag = false;
-            }
-            else
-            {
-                char first = names_[index_][0];     // first symbol of #arg (detect literals and numbers)
-                asisFlag = (first == '"' || first=='\'' || ( first >= '0' && first <= '9' )
-                            || detectNested(names_[index_]));
-                excludeName = asisFlag;
-            }
+            asisFlag = (flagsAt(index_) & ArgName::AsIs);
+            excludeName = asisFlag || index_ >= N;
             modeToStr = ( detailed_==Details::Normal  ? ENUM_TOSTR_REPR : 
                           (detailed_==Details::NormalHex ? ENUM_TOSTR_REPR_HEX : ENUM_TOSTR_EXTENDED) );
             if ( !excludeName )
@@ -194,8 +223,9 @@ private:
 
         // 2. Do output
         if ( !excludeName )
-            acc_str_ += std::string(names_[index_]) + betweenToken;
-        acc_str_ +=  toStr( head, asisFlag ? ENUM_TOSTR_DEFAULT : modeToStr ) + suffix;
+            acc_str_.append( names_[index_].name ).append( betweenToken );
+        appendTo( acc_str_, head, asisFlag ? ENUM_TOSTR_DEFAULT : modeToStr );
+        acc_str_.append( suffix );
 
         index_++;
         joinOnce_ = false;
@@ -204,6 +234,9 @@ private:
 
 };
 
+template<std::size_t N>
+Printer( Mode, const ArgName (&)[N] ) -> Printer<N>;
+
 }  // namespace tsv::util::tostr
 
 
@@ -212,34 +245,44 @@ private:
 #define MACRO_TOSTR__CHOOSE_NTH(a50,a49,a48,a47,a46,a45,a44,a43,a42,a41,a40,a39,a38,a37,a36,a35,a34,a33,a32,a31,a30,a29,a28,a27,a26,a25,a24,a23,a22,a21,a20,a19,a18,a17,a16,a15,a14,a13,a12,a11,a10,a09,a08,a07,a06,a05,a04,a03,a02,a01, num, ...) num
 //                                                                        (a50,a49,a48,a47,a46,a45,a44,a43,a42,a41,a40,a39,a38,a37,a36,a35,a34,a33,a32,a31,a30,a29,a28,a27,a26,a25,a24,a23,a22,a21,a20,a19,a18,a17,a16,a15,a14,a13,a12,a11,a10,a09,a08,a07,a06,a05,a04,a03,a02,a01, num
 #define MACRO_TOSTR__GET_ARG_NUM(...) MACRO_TOSTR__CHOOSE_NTH( __VA_ARGS__,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 09, 08, 07, 06, 05, 04, 03, 02, 01, 00 )
-#define MACRO_TOSTR__EXPAND_EACH_00()
-#define MACRO_TOSTR__EXPAND_EACH_01(a01) #a01
-#define MACRO_TOSTR__EXPAND_EACH_02(a01,a02) #a01, #a02
-#define MACRO_TOSTR__EXPAND_EACH_03(a01,a02,a03) #a01, #a02, #a03
-#define MACRO_TOSTR__EXPAND_EACH_04(a01,a02,a03,a04) #a01, #a02, #a03, #a04
-#define MACRO_TOSTR__EXPAND_EACH_05(a01,a02,a03,a04,a05) #a01, #a02, #a03, #a04, #a05
-#define MACRO_TOSTR__EXPAND_EACH_06(a01,a02,a03,a04,a05,a06) #a01, #a02, #a03, #a04, #a05, #a06
-#define MACRO_TOSTR__EXPAND_EACH_07(a01,a02,a03,a04,a05,a06,a07) #a01, #a02, #a03, #a04, #a05, #a06, #a07
-#define MACRO_TOSTR__EXPAND_EACH_08(a01,a02,a03,a04,a05,a06,a07,a08) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08
-#define MACRO_TOSTR__EXPAND_EACH_09(a01,a02,a03,a04,a05,a06,a07,a08,a09) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09
-#define MACRO_TOSTR__EXPAND_EACH_10(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10
-#define MACRO_TOSTR__EXPAND_EACH_11(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11
-#define MACRO_TOSTR__EXPAND_EACH_12(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12
-#define MACRO_TOSTR__EXPAND_EACH_13(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13
-#define MACRO_TOSTR__EXPAND_EACH_14(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14
-#define MACRO_TOSTR__EXPAND_EACH_15(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15
-#define MACRO_TOSTR__EXPAND_EACH_16(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16
-#define MACRO_TOSTR__EXPAND_EACH_17(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17
-#define MACRO_TOSTR__EXPAND_EACH_18(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18
-#define MACRO_TOSTR__EXPAND_EACH_19(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18, #a19
-#define MACRO_TOSTR__EXPAND_EACH_20(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18, #a19, #a20
-#define MACRO_TOSTR__EXPAND_EACH_21(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18, #a19, #a20, #a21
-#define MACRO_TOSTR__EXPAND_EACH_22(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18, #a19, #a20, #a21, #a22
-#define MACRO_TOSTR__EXPAND_EACH_23(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22,a23) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18, #a19, #a20, #a21, #a22, #a23
-#define MACRO_TOSTR__EXPAND_EACH_24(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22,a23,a24) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18, #a19, #a20, #a21, #a22, #a23, #a24
-#define MACRO_TOSTR__EXPAND_EACH_25(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22,a23,a24,a25) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18, #a19, #a20, #a21, #a22, #a23, #a24, #a25
-#define MACRO_TOSTR__EXPAND_EACH_N(a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22,a23,a24,a25,...) #a01, #a02, #a03, #a04, #a05, #a06, #a07, #a08, #a09, #a10, #a11, #a12, #a13, #a14, #a15, #a16, #a17, #a18, #a19, #a20, #a21, #a22, #a23, #a24, #a25, MACRO_TOSTR__EXPAND_EACH_VAL_AGAIN(__VA_ARGS__)
+#define MACRO_TOSTR__EXPAND_EACH_00(op)
+#define MACRO_TOSTR__EXPAND_EACH_01(op, a01) op(a01)
+#define MACRO_TOSTR__EXPAND_EACH_02(op, a01,a02) op(a01), op(a02)
+#define MACRO_TOSTR__EXPAND_EACH_03(op, a01,a02,a03) op(a01), op(a02), op(a03)
+#define MACRO_TOSTR__EXPAND_EACH_04(op, a01,a02,a03,a04) op(a01), op(a02), op(a03), op(a04)
+#define MACRO_TOSTR__EXPAND_EACH_05(op, a01,a02,a03,a04,a05) op(a01), op(a02), op(a03), op(a04), op(a05)
+#define MACRO_TOSTR__EXPAND_EACH_06(op, a01,a02,a03,a04,a05,a06) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06)
+#define MACRO_TOSTR__EXPAND_EACH_07(op, a01,a02,a03,a04,a05,a06,a07) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07)
+#define MACRO_TOSTR__EXPAND_EACH_08(op, a01,a02,a03,a04,a05,a06,a07,a08) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08)
+#define MACRO_TOSTR__EXPAND_EACH_09(op, a01,a02,a03,a04,a05,a06,a07,a08,a09) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09)
+#define MACRO_TOSTR__EXPAND_EACH_10(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10)
+#define MACRO_TOSTR__EXPAND_EACH_11(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11)
+#define MACRO_TOSTR__EXPAND_EACH_12(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12)
+#define MACRO_TOSTR__EXPAND_EACH_13(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13)
+#define MACRO_TOSTR__EXPAND_EACH_14(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14)
+#define MACRO_TOSTR__EXPAND_EACH_15(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15)
+#define MACRO_TOSTR__EXPAND_EACH_16(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16)
+#define MACRO_TOSTR__EXPAND_EACH_17(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17)
+#define MACRO_TOSTR__EXPAND_EACH_18(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18)
+#define MACRO_TOSTR__EXPAND_EACH_19(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18), op(a19)
+#define MACRO_TOSTR__EXPAND_EACH_20(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18), op(a19), op(a20)
+#define MACRO_TOSTR__EXPAND_EACH_21(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18), op(a19), op(a20), op(a21)
+#define MACRO_TOSTR__EXPAND_EACH_22(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18), op(a19), op(a20), op(a21), op(a22)
+#define MACRO_TOSTR__EXPAND_EACH_23(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22,a23) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18), op(a19), op(a20), op(a21), op(a22), op(a23)
+#define MACRO_TOSTR__EXPAND_EACH_24(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22,a23,a24) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18), op(a19), op(a20), op(a21), op(a22), op(a23), op(a24)
+#define MACRO_TOSTR__EXPAND_EACH_25(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22,a23,a24,a25) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18), op(a19), op(a20), op(a21), op(a22), op(a23), op(a24), op(a25)
+#define MACRO_TOSTR__EXPAND_EACH_N(op, a01,a02,a03,a04,a05,a06,a07,a08,a09,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20,a21,a22,a23,a24,a25,...) op(a01), op(a02), op(a03), op(a04), op(a05), op(a06), op(a07), op(a08), op(a09), op(a10), op(a11), op(a12), op(a13), op(a14), op(a15), op(a16), op(a17), op(a18), op(a19), op(a20), op(a21), op(a22), op(a23), op(a24), op(a25), MACRO_TOSTR__EXPAND_EACH_AGAIN(op, __VA_ARGS__)
 #define MACRO_TOSTR__TOKEN_PASTE_IMPL(x,y) x ## y
 #define MACRO_TOSTR__TOKEN_PASTE(x,y) MACRO_TOSTR__TOKEN_PASTE_IMPL(x,y)
-#define MACRO_TOSTR__EXPAND_EACH_VAL(...) MACRO_TOSTR__TOKEN_PASTE(MACRO_TOSTR__EXPAND_EACH_, MACRO_TOSTR__GET_ARG_NUM(__VA_ARGS__))( __VA_ARGS__ )
-#define MACRO_TOSTR__EXPAND_EACH_VAL_AGAIN(...) MACRO_TOSTR__TOKEN_PASTE(MACRO_TOSTR__EXPAND_EACH_, MACRO_TOSTR__GET_ARG_NUM(__VA_ARGS__))( __VA_ARGS__ )
+#define MACRO_TOSTR__EXPAND_EACH(op, ...) MACRO_TOSTR__TOKEN_PASTE(MACRO_TOSTR__EXPAND_EACH_, MACRO_TOSTR__GET_ARG_NUM(__VA_ARGS__))( op, __VA_ARGS__ )
+#define MACRO_TOSTR__EXPAND_EACH_AGAIN(op, ...) MACRO_TOSTR__TOKEN_PASTE(MACRO_TOSTR__EXPAND_EACH_, MACRO_TOSTR__GET_ARG_NUM(__VA_ARGS__))( op, __VA_ARGS__ )
+
+// List of stringized arguments
+#define MACRO_TOSTR__EXPAND_EACH_VAL(...) MACRO_TOSTR__EXPAND_EACH(MACRO_TOSTR__STRINGIZE_IMPL, __VA_ARGS__)
+
+// Static table of classified names (see ArgName) which is built at compile time
+#define MACRO_TOSTR__CLASSIFY(x) ::tsv::util::tostr::classifyArg(#x)
+#define MACRO_TOSTR__ARG_NAMES(...) MACRO_TOSTR__EXPAND_EACH(MACRO_TOSTR__CLASSIFY, __VA_ARGS__)
+#define MACRO_TOSTR__ARG_TABLE(...) []() -> const auto& { \
+            static constexpr ::tsv::util::tostr::ArgName names[] = { MACRO_TOSTR__ARG_NAMES(__VA_ARGS__) }; \
+            return names; }()
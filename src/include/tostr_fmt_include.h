@@ -5,14 +5,18 @@
  */
 
 #undef TOSTR_FMT
+#undef TOSTR_VFMT
 
 #if __has_include(<fmt/format.h>)
 #include <fmt/format.h>
 #define TOSTR_FMT(...) fmt::format( __VA_ARGS__ )
+// Format with runtime format string
+#define TOSTR_VFMT(fmtStr, ...) fmt::vformat( fmtStr, fmt::make_format_args( __VA_ARGS__ ) )
 
 #elif __has_include(<format>)
 #include <format>
 #define TOSTR_FMT(...) std::format( __VA_ARGS__ )
+#define TOSTR_VFMT(fmtStr, ...) std::vformat( fmtStr, std::make_format_args( __VA_ARGS__ ) )
 
 #else
 static_assert(false, "No format library detected");
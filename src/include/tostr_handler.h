@@ -9,6 +9,7 @@
 */
 
 #include <string>
+#include <string_view>
 #include <type_traits>      // SFINAE checks
 #include <typeinfo>         // typeid
 
@@ -23,19 +24,41 @@
 #include <reflect>
 #undef NTEST
 #endif
+#undef DEBUGLOG_USEREFLECT_ENUM
+#undef DEBUGLOG_USEMAGIC_ENUM
+#define DEBUGLOG_USEREFLECT_ENUM 1
 #define DEBUGLOG_USEMAGIC_ENUM 0
 
 #elif defined(DEBUGLOG_USEMAGIC_ENUM) && __has_include(<magic_enum.hpp>)
    // second choice - magic_enum as C++17 compatible
 #include <magic_enum.hpp>
+#undef DEBUGLOG_USEREFLECT_ENUM
+#undef DEBUGLOG_USEMAGIC_ENUM
 #define DEBUGLOG_USEREFLECT_ENUM 0
+#define DEBUGLOG_USEMAGIC_ENUM 1
 
 #else
+#undef DEBUGLOG_USEREFLECT_ENUM
+#undef DEBUGLOG_USEMAGIC_ENUM
 #define DEBUGLOG_USEREFLECT_ENUM 0
 #define DEBUGLOG_USEMAGIC_ENUM 0
 
 #endif
 
+#if DEBUGLOG_USEREFLECT_ENUM || DEBUGLOG_USEMAGIC_ENUM
+#include <algorithm>        // enum names table
+#include <cstdint>
+#include <vector>
+#endif
+
+// 1 - take type names from __PRETTY_FUNCTION__ at compile time (where the compiler allows it).
+//     They are shorter than demangled ones: default template arguments are omitted,
+//     and the spelling of lambdas depends on the compiler.
+// 0 - demangle the name of typeid() once per type
+#ifndef TOSTR_COMPILE_TIME_TYPE_NAMES
+#define TOSTR_COMPILE_TIME_TYPE_NAMES 0
+#endif
+
 namespace tsv::util::tostr::settings
 {
     extern bool showNullptrType;
@@ -48,7 +71,7 @@ namespace tsv::util::tostr::settings
 // Forward declaration from debugresolve.h
 namespace tsv::debuglog
 {
-    std::string demangle(const char* name);
+    const std::string& demangle(const char* name);
     std::string resolveAddr2Name(const void* addr, bool addLineNum, bool includeHexAddr);
 }
 
@@ -81,11 +104,48 @@ namespace tsv::util::tostr
 
 // Auxiliary function to decode pointer to hex string
 std::string hex_addr( const void* ptr );
+// Same, but append to the `out`
+void appendHexAddr( std::string& out, const void* ptr );
+
+namespace impl
+{
+// Name of T extracted from the signature of this function at compile time (empty if not available)
+template<typename T>
+constexpr std::string_view prettyTypeName()
+{
+#if !TOSTR_COMPILE_TIME_TYPE_NAMES
+    return {};
+#elif defined(__clang__)
+    std::string_view base = __PRETTY_FUNCTION__;    // "... prettyTypeName() [T = int]"
+    std::string_view prefix = "[T = ";
+    auto start = base.find(prefix);
+    if (start == std::string_view::npos)
+        return {};
+    start += prefix.size();
+    return base.substr(start, base.rfind(']') - start);
+#elif defined(__GNUC__)
+    std::string_view base = __PRETTY_FUNCTION__;    // "... prettyTypeName() [with T = int; std::string_view = ...]"
+    std::string_view prefix = "[with T = ";
+    auto start = base.find(prefix);
+    if (start == std::string_view::npos)
+        return {};
+    start += prefix.size();
+    return base.substr(start, base.find_first_of(";]", start) - start);
+#else
+    return {};
+#endif
+}
+}  // namespace impl
 
+// Pretty name of the type. Computed once per type.
 template<typename T>
-std::string getTypeName()
+const std::string& getTypeName()
 {
-    return ::tsv::debuglog::demangle(typeid(T).name());
+    static const std::string name = [] {
+        constexpr std::string_view pretty = impl::prettyTypeName<T>();
+        return pretty.empty() ? ::tsv::debuglog::demangle(typeid(T).name()) : std::string(pretty);
+    }();
+    return name;
 }
 
 /************************* KNOWN OBJECTS NAMES  *******************************/
@@ -165,7 +225,7 @@ std::string extended(const T& value);
 
 // convert container to joined string
 template <class T>
-std::string join(const T& value, std::string separator = ", ", int mode = ENUM_TOSTR_REPR);
+std::string join(const T& value, std::string_view separator = ", ", int mode = ENUM_TOSTR_REPR);
 
 namespace impl
 {
@@ -180,6 +240,13 @@ struct ToStringRV
 std::string __toStringULongHex(unsigned long);
 std::string __toStringLongHex(long);
 
+// Append representation of the built-in types (see appendTo())
+void __appendInteger(std::string& out, long long value, bool hex);
+void __appendInteger(std::string& out, unsigned long long value, bool hex);
+void __appendFloat(std::string& out, double value);
+void __appendFloat(std::string& out, long double value);
+void __appendString(std::string& out, std::string_view value, int mode);
+
 // Default handler
 template<typename T>
 typename std::enable_if< !std::is_arithmetic<T>::value && !std::is_enum<T>::value, ToStringRV >::type
@@ -201,48 +268,178 @@ __toString(const T& value, int mode)
              , true };
 }
 
+// Result of the generic enum handler (distinguish it from the handlers of the particular enums)
+struct EnumToStringRV : ToStringRV
+{
+};
+
+#if DEBUGLOG_USEREFLECT_ENUM || DEBUGLOG_USEMAGIC_ENUM
+/**
+ * Names of all values of the enum type: "ns::Enum::Value(3)". Values and their short names
+ * are given by the reflection library at compile time, they are joined with the type name
+ * once per type. Lookup is the index for contiguous enum, and binary search otherwise.
+ */
+template<typename E>
+class EnumNames
+{
+public:
+    using Value = std::underlying_type_t<E>;
+
+    static const EnumNames& get()
+    {
+        static const EnumNames names;
+        return names;
+    }
+
+    // "ns::Enum::Value(3)" or "ns::Enum::Value" (empty if the value has no name)
+    std::string_view find(E value, bool withInteger) const
+    {
+        auto numValue = static_cast<Value>(value);
+        const Entry* entry = nullptr;
+        if (entries_.empty())
+            return {};
+        if (dense_)
+        {
+            // Compare first to avoid overflow of the difference
+            if (numValue >= entries_.front().value && numValue <= entries_.back().value)
+                entry = &entries_[static_cast<std::size_t>(numValue - entries_.front().value)];
+        }
+        else
+        {
+            auto it = std::lower_bound(entries_.begin(), entries_.end(), numValue,
+                                       [](const Entry& e, Value v) { return e.value < v; });
+            if (it != entries_.end() && it->value == numValue)
+                entry = &*it;
+        }
+        if (!entry)
+            return {};
+        return std::string_view(names_).substr(entry->offset, withInteger ? entry->size : entry->shortSize);
+    }
+
+    // "ns::Enum::"
+    std::string_view prefix() const
+    {
+        return std::string_view(names_).substr(0, prefixSize_);
+    }
+
+private:
+    struct Entry
+    {
+        Value value;
+        std::uint32_t offset;
+        std::uint32_t size;         // with "(integer)"
+        std::uint32_t shortSize;    // without "(integer)"
+    };
+
+    EnumNames()
+    {
+        names_ = getTypeName<E>();
+        names_.append("::");
+        prefixSize_ = names_.size();
+        for (auto value : values())
+        {
+            std::string_view name = shortName(value);
+            // Values without name are not reflected
+            if (name.empty() || !(name[0] == '_' || (name[0] >= 'A' && name[0] <= 'Z') || (name[0] >= 'a' && name[0] <= 'z')))
+                continue;
+            Entry entry{static_cast<Value>(value), static_cast<std::uint32_t>(names_.size()), 0, 0};
+            names_.append(prefix()).append(name);
+            entry.shortSize = static_cast<std::uint32_t>(names_.size() - entry.offset);
+            names_.push_back('(');
+            __appendInteger(names_, static_cast<std::conditional_t<std::is_signed<Value>::value, long long, unsigned long long>>(entry.value), false);
+            names_.push_back(')');
+            entry.size = static_cast<std::uint32_t>(names_.size() - entry.offset);
+            entries_.push_back(entry);
+        }
+        std::sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.value < b.value; });
+        entries_.erase(std::unique(entries_.begin(), entries_.end(),
+                                   [](const Entry& a, const Entry& b) { return a.value == b.value; }),
+                       entries_.end());
+        dense_ = entries_.empty()
+                 || static_cast<std::size_t>(entries_.back().value - entries_.front().value) + 1 == entries_.size();
+    }
+
+    static auto values()
+    {
+#if DEBUGLOG_USEREFLECT_ENUM
+        std::vector<E> rv;
+        for (auto v = ::reflect::enum_min(E{}); v <= ::reflect::enum_max(E{}); v++)
+            rv.push_back(static_cast<E>(v));
+        return rv;
+#else
+        return ::magic_enum::enum_values<E>();
+#endif
+    }
+
+    static std::string_view shortName(E value)
+    {
+#if DEBUGLOG_USEREFLECT_ENUM
+        return ::reflect::enum_name(value);
+#else
+        return ::magic_enum::enum_name(value);
+#endif
+    }
+
+    std::string names_;             // prefix followed by full names of all values
+    std::size_t prefixSize_ = 0;
+    std::vector<Entry> entries_;    // sorted by value
+    bool dense_ = true;
+};
+#endif
+
+// Append representation of enum value
 template<typename T>
-typename std::enable_if< std::is_enum<T>::value, ToStringRV >::type
-__toString(const T& value, int /*mode*/)
+void __appendEnum(std::string& out, const T& value)
 {
-    std::string typeName = ::tsv::debuglog::demangle(typeid(T).name()) + "::";
     auto numValue = static_cast<std::underlying_type_t<T>>(value);
-#if !defined(DEBUGLOG_USEREFLECT_ENUM)
-   typeName += ::reflect::enum_name(value);
-   if (tsv::util::tostr::settings::showEnumInteger)
-       return  { typeName + "(" + std::to_string(numValue) + ")", true };
-   return  { typeName, true };
-#elif !defined(DEBUGLOG_USEMAGIC_ENUM)
-   typeName += ::magic_enum::enum_name(value);
-   if (tsv::util::tostr::settings::showEnumInteger)
-       return  { typeName + "(" + std::to_string(numValue) + ")", true };
-   return  { typeName, true };
+    using Integer = std::conditional_t<std::is_signed<std::underlying_type_t<T>>::value, long long, unsigned long long>;
+#if DEBUGLOG_USEREFLECT_ENUM || DEBUGLOG_USEMAGIC_ENUM
+    const auto& names = EnumNames<T>::get();
+    auto name = names.find(value, tsv::util::tostr::settings::showEnumInteger);
+    if (!name.empty())
+    {
+        out.append(name);
+        return;
+    }
+    // Not reflected value
+    out.append(names.prefix());
+    if (tsv::util::tostr::settings::showEnumInteger)
+    {
+        out.push_back('(');
+        __appendInteger(out, static_cast<Integer>(numValue), false);
+        out.push_back(')');
+    }
 #else
-    return { typeName + std::to_string(numValue), true };
+    out.append(getTypeName<T>()).append("::");
+    __appendInteger(out, static_cast<Integer>(numValue), false);
 #endif
 }
 
+template<typename T>
+typename std::enable_if< std::is_enum<T>::value, EnumToStringRV >::type
+__toString(const T& value, int /*mode*/)
+{
+    EnumToStringRV rv{};
+    __appendEnum(rv.value_, value);
+    rv.valid_ = true;
+    return rv;
+}
+
 // std::string handler
 ToStringRV __toString(const std::string& value, int mode);
 ToStringRV __toString(const std::string_view& value, int mode);
 ToStringRV __toString(const bool value, int mode);
 
 template<typename... Types> ToStringRV __toString(const std::variant<Types...>& value, int mode);
-template<typename T> ToStringRV __toString(const std::shared_ptr<T>& value, int mode);
-template<typename T, class Deleter> ToStringRV __toString(const std::unique_ptr<T, Deleter>& value, int mode);
-template<typename T> ToStringRV __toString(const std::shared_ptr<T>& value, int mode);
-template<typename T> ToStringRV __toString(const std::weak_ptr<T>& value, int mode);
-template<typename T1, typename T2> ToStringRV __toString(const std::pair<T1,T2>& value, int mode);
-template<typename Ret, typename... Args> ToStringRV __toString(const std::function<Ret(Args...)>& f, [[maybe_unused]]int mode = ENUM_TOSTR_DEFAULT);
 
-
-template<typename T>
-ToStringRV __toString(const std::optional<T>& value, int mode)
-{
-   if (!value.has_value())
-       return {"no_value", true};
-   return __toString(*value, mode);
-}
+// Handlers which append directly to the output (could be defined for user classes as well).
+// Return false if the value is not recognized.
+template<typename T, class Deleter> bool __appendTo(std::string& out, const std::unique_ptr<T, Deleter>& value, int mode);
+template<typename T> bool __appendTo(std::string& out, const std::shared_ptr<T>& value, int mode);
+template<typename T> bool __appendTo(std::string& out, const std::weak_ptr<T>& value, int mode);
+template<typename T1, typename T2> bool __appendTo(std::string& out, const std::pair<T1,T2>& value, int mode);
+template<typename Ret, typename... Args> bool __appendTo(std::string& out, const std::function<Ret(Args...)>& f, int mode);
+template<typename T> bool __appendTo(std::string& out, const std::optional<T>& value, int mode);
 
 }  // namespace impl
 }  // namespace tsv::util::tostr
@@ -256,100 +453,197 @@ ToStringRV __toString(const std::optional<T>& value, int mode)
 namespace tsv::util::tostr
 {
 
+namespace impl
+{
+
+// True if there is __appendTo() exactly for the type (without implicit conversions)
+template<typename T, typename = void>
+struct HasAppendTo : std::false_type {};
+
+template<typename T>
+struct HasAppendTo<T, std::void_t<decltype(static_cast<bool (*)(std::string&, const T&, int)>(&__appendTo))>>
+    : std::true_type {};
+
+// Append the value with the handler of its type. Return false if there is no one.
+template<typename T>
+bool __appendValue(std::string& out, const T& value, int mode)
+{
+    if constexpr (HasAppendTo<T>::value)
+    {
+        return __appendTo(out, value, mode);
+    }
+    else if constexpr (std::is_same<T, bool>::value)
+    {
+        out.append(value ? "true" : "false");
+        return true;
+    }
+    else if constexpr (std::is_integral<T>::value)
+    {
+        if constexpr (std::is_signed<T>::value)
+            __appendInteger(out, static_cast<long long>(value), mode == ENUM_TOSTR_REPR_HEX);
+        else
+            __appendInteger(out, static_cast<unsigned long long>(value), mode == ENUM_TOSTR_REPR_HEX);
+        return true;
+    }
+    else if constexpr (std::is_floating_point<T>::value)
+    {
+        __appendFloat(out, value);
+        return true;
+    }
+    else if constexpr (std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value)
+    {
+        __appendString(out, value, mode);
+        return true;
+    }
+    else if constexpr (std::is_enum<T>::value
+                       && std::is_same<decltype(__toString(value, mode)), EnumToStringRV>::value)
+    {
+        // Enum without own handler
+        __appendEnum(out, value);
+        return true;
+    }
+    else
+    {
+        // Handlers which return the string
+        auto decoded = __toString(value, mode);
+        if (decoded.valid_)
+            out.append(decoded.value_);
+        return decoded.valid_;
+    }
+}
+
+}  // namespace impl
+
 /**********************************************
-    Main toStr() interface.
+    Main appendTo() / toStr() interface.
 
-Purpose: Print val to std::string
+Purpose: Print val to the end of given std::string (appendTo) or to the new std::string (toStr)
 Usage:
     std::string val = toStr(var);
     std::string val = toStr(var, ENUM_TOSTR_EXTENDED);
+    appendTo(buffer, var);
 ************************************************/
 // Main implementation for values
 template<typename T>
-typename std::enable_if< !std::is_pointer<T>::value && !std::is_function<T>::value, std::string >::type
-//typename std::enable_if<!std::is_pointer<T>::value && !std::is_base_of<C, T>::value, void>::type
-toStr(const T& val, int mode = ENUM_TOSTR_DEFAULT)
+typename std::enable_if< !std::is_pointer<T>::value && !std::is_function<T>::value >::type
+appendTo(std::string& out, const T& val, int mode = ENUM_TOSTR_DEFAULT)
 {
-    auto decoded = impl::__toString( val, mode );
-    if ( !decoded.valid_ )
-    {
-        // If no known converter found, return typename (with reference if enabled)
-        if ( !settings::showUnknownValueAsRef )
-            return getTypeName<T>();
-
-        // If that known shortcut, return it
-        std::string pointerName = known_pointers::getName( &val );
-        if ( !pointerName.empty() )
-            return "*" + pointerName + "["+ hex_addr(&val)+"]";
+    if ( impl::__appendValue( out, val, mode ) )
+        return;
 
-        return "*" + hex_addr(&val) + " (" + getTypeName<T>() + ")";
+    // If no known converter found, print typename (with reference if enabled)
+    if ( !settings::showUnknownValueAsRef )
+    {
+        out.append( getTypeName<T>() );
+        return;
     }
 
-    return decoded.value_;
+    // If that known shortcut, print it
+    out.push_back( '*' );
+    std::string pointerName = known_pointers::getName( &val );
+    if ( !pointerName.empty() )
+    {
+        out.append( pointerName ).push_back( '[' );
+        appendHexAddr( out, &val );
+        out.push_back( ']' );
+        return;
+    }
+    appendHexAddr( out, &val );
+    out.append( " (" ).append( getTypeName<T>() ).push_back( ')' );
 }
 
 // Special case for function pointers
 template<typename Ret, typename... Args>
-std::string toStr(Ret (*val)(Args...), [[maybe_unused]]int mode = ENUM_TOSTR_DEFAULT)
+void appendTo(std::string& out, Ret (*val)(Args...), [[maybe_unused]]int mode = ENUM_TOSTR_DEFAULT)
 {
     if ( !val )
     {
+        out.append( "nullptr" );
         if ( settings::showNullptrType )
-            return "nullptr (" + getTypeName<Ret(*)(Args...)>() + ")";
-        else
-            return "nullptr";
+            out.append( " (" ).append( getTypeName<Ret(*)(Args...)>() ).push_back( ')' );
+        return;
     }
 
-    std::string rv = hex_addr(reinterpret_cast<const void*>(val));
-    if (settings::showFnPtrContent)
+    appendHexAddr( out, reinterpret_cast<const void*>(val) );
+    if ( settings::showFnPtrContent )
     {
-        rv += " (" + getTypeName<Ret(*)(Args...)>() + "/"
-             + tsv::debuglog::resolveAddr2Name(reinterpret_cast<const void*>(val),false,false)
-             + ")";
+        out.append( " (" ).append( getTypeName<Ret(*)(Args...)>() ).push_back( '/' );
+        out.append( tsv::debuglog::resolveAddr2Name(reinterpret_cast<const void*>(val),false,false) );
+        out.push_back( ')' );
     }
-
-    return rv;
 }
 
 // Main implementation for pointers
 template<typename T>
-std::string toStr(const T* val, int mode = ENUM_TOSTR_DEFAULT)
+void appendTo(std::string& out, const T* val, int mode = ENUM_TOSTR_DEFAULT)
 {
     if ( !val )
     {
+        out.append( "nullptr" );
         if ( settings::showNullptrType )
-            return "nullptr (" + getTypeName<T>() + ")";
-        else
-            return "nullptr";
+            out.append( " (" ).append( getTypeName<T>() ).push_back( ')' );
+        return;
     }
 
-    // if known shortcut, return it
-    std::string rv = known_pointers::getName(reinterpret_cast<const void*>(val));
-    if ( !rv.empty() )
-        rv += "[" + hex_addr(reinterpret_cast<const void*>(val)) + "]";
+    // if known shortcut, print it
+    std::string pointerName = known_pointers::getName(reinterpret_cast<const void*>(val));
+    if ( !pointerName.empty() )
+    {
+        out.append( pointerName ).push_back( '[' );
+        appendHexAddr( out, reinterpret_cast<const void*>(val) );
+        out.push_back( ']' );
+    }
     else
-        rv = hex_addr(reinterpret_cast<const void*>(val));
+    {
+        appendHexAddr( out, reinterpret_cast<const void*>(val) );
+    }
 
     // If val is not pointer to pointer, then show its content
     // Important note: pointer should be valid
-    if ( !std::is_pointer<T>() )
+    if constexpr ( !std::is_pointer<T>::value )
     {
-        // Get content
         if (settings::showPtrContent)
         {
-            auto decoded = impl::__toString( *val, mode );
+            out.append( " (" );
             // If no known converter found, use typename as content
-            if ( !decoded.valid_ )
-               rv += " (" + getTypeName<T>() + ")";
-            else
-               rv += " (" + decoded.value_ + ")";
+            if ( !impl::__appendValue( out, *val, mode ) )
+               out.append( getTypeName<T>() );
+            out.push_back( ')' );
         }
-     }
+    }
+}
 
+/**      Some basic specializations of handlers     **/
+void appendTo(std::string& out, void* v, int mode = ENUM_TOSTR_DEFAULT);
+void appendTo(std::string& out, std::nullptr_t value, int mode = ENUM_TOSTR_DEFAULT);
+void appendTo(std::string& out, const char* v, int mode = ENUM_TOSTR_DEFAULT);
+
+// toStr() are the wrappers of the appendTo()
+template<typename T>
+typename std::enable_if< !std::is_pointer<T>::value && !std::is_function<T>::value, std::string >::type
+toStr(const T& val, int mode = ENUM_TOSTR_DEFAULT)
+{
+    std::string rv;
+    appendTo( rv, val, mode );
+    return rv;
+}
+
+template<typename Ret, typename... Args>
+std::string toStr(Ret (*val)(Args...), int mode = ENUM_TOSTR_DEFAULT)
+{
+    std::string rv;
+    appendTo( rv, val, mode );
+    return rv;
+}
+
+template<typename T>
+std::string toStr(const T* val, int mode = ENUM_TOSTR_DEFAULT)
+{
+    std::string rv;
+    appendTo( rv, val, mode );
     return rv;
 }
 
-/**      Some basic specializations of handlers     **/
 std::string toStr(void* v, int mode = ENUM_TOSTR_DEFAULT);
 std::string toStr(std::nullptr_t value, int mode = ENUM_TOSTR_DEFAULT);
 std::string toStr(const char* v, int mode = ENUM_TOSTR_DEFAULT);
@@ -361,56 +655,81 @@ namespace impl
 {
 
 template<typename T, class Deleter>
-ToStringRV __toString(const std::unique_ptr<T, Deleter>& value, int mode)
+bool __appendTo(std::string& out, const std::unique_ptr<T, Deleter>& value, int mode)
 {
-    std::string rv = tsv::util::tostr::toStr( value.get(), mode );
-    return {"unique_ptr:" + rv, true};
+    out.append( "unique_ptr:" );
+    tsv::util::tostr::appendTo( out, value.get(), mode );
+    return true;
 }
 
 template<typename T>
-ToStringRV __toString(const std::shared_ptr<T>& value, int mode)
+bool __appendTo(std::string& out, const std::shared_ptr<T>& value, int mode)
 {
-    std::string rv = tsv::util::tostr::toStr( value.get(), mode );
-    return {"shared_ptr(" + std::to_string(value.use_count()) + "):" + rv, true};
+    out.append( "shared_ptr(" );
+    __appendInteger( out, static_cast<long long>(value.use_count()), false );
+    out.append( "):" );
+    tsv::util::tostr::appendTo( out, value.get(), mode );
+    return true;
 }
 
 template<typename T>
-ToStringRV __toString(const std::weak_ptr<T>& value, int mode)
+bool __appendTo(std::string& out, const std::weak_ptr<T>& value, int mode)
 {
-    std::string rv = tsv::util::tostr::toStr( value.lock().get(), mode );
-    return {"weak_ptr(" + std::to_string(value.use_count()) + "):" + rv, true};
+    out.append( "weak_ptr(" );
+    __appendInteger( out, static_cast<long long>(value.use_count()), false );
+    out.append( "):" );
+    tsv::util::tostr::appendTo( out, value.lock().get(), mode );
+    return true;
 }
 
 template<typename Ret, typename... Args>
-ToStringRV __toString(const std::function<Ret(Args...)>& f, int /*mode*/)
+bool __appendTo(std::string& out, const std::function<Ret(Args...)>& f, int /*mode*/)
 {
     typedef Ret(*FunctionPtr)(Args...);
 
-    if (!f) 
-        return { "nullptr ("+ getTypeName<FunctionPtr>() +")", true };
+    if (!f)
+    {
+        out.append( "nullptr (" ).append( getTypeName<FunctionPtr>() ).push_back( ')' );
+        return true;
+    }
 
     if (auto fptr = f.template target<FunctionPtr>())
     {
-        std::string rv = hex_addr(reinterpret_cast<const void*>(fptr));
+        appendHexAddr( out, reinterpret_cast<const void*>(fptr) );
         if (settings::showFnPtrContent)
         {
-            rv += " (" + getTypeName<Ret(*)(Args...)>() + "/"
-                 + tsv::debuglog::resolveAddr2Name(reinterpret_cast<const void*>(fptr),false,false)
-                 + ")";
+            out.append( " (" ).append( getTypeName<Ret(*)(Args...)>() ).push_back( '/' );
+            out.append( tsv::debuglog::resolveAddr2Name(reinterpret_cast<const void*>(fptr),false,false) );
+            out.push_back( ')' );
         }
-
-        return { rv, true };
+        return true;
     }
 
-    return  { std::string("(callable type: ") + ::tsv::debuglog::demangle(f.target_type().name())  + ")", true };
+    out.append( "(callable type: " ).append( ::tsv::debuglog::demangle(f.target_type().name()) ).push_back( ')' );
+    return true;
 }
 
-template<typename T1, typename T2> ToStringRV __toString(const std::pair<T1,T2>& value, int mode)
+template<typename T1, typename T2>
+bool __appendTo(std::string& out, const std::pair<T1,T2>& value, int mode)
 {
     mode = (mode == ENUM_TOSTR_DEFAULT) ? ENUM_TOSTR_REPR : mode;
-    return {"{" + tsv::util::tostr::toStr(value.first, mode) + ": "
-                + tsv::util::tostr::toStr(value.second, mode) + "}",
-            true};
+    out.push_back( '{' );
+    tsv::util::tostr::appendTo( out, value.first, mode );
+    out.append( ": " );
+    tsv::util::tostr::appendTo( out, value.second, mode );
+    out.push_back( '}' );
+    return true;
+}
+
+template<typename T>
+bool __appendTo(std::string& out, const std::optional<T>& value, int mode)
+{
+    if (!value.has_value())
+    {
+        out.append( "no_value" );
+        return true;
+    }
+    return __appendValue( out, *value, mode );
 }
 
 } // namespace impl
@@ -422,16 +741,26 @@ std::string extended(const T& value)
     return toStr(value, ENUM_TOSTR_EXTENDED);
 }
 
-// convert container to joined string
+// append joined container to the `out`
 template <class T>
-std::string join(const T& value, std::string separator/* = ", "*/, int mode /*= ENUM_TOSTR_REPR*/)
+void appendJoin(std::string& out, const T& value, std::string_view separator = ", ", int mode = ENUM_TOSTR_REPR)
 {
-    int cntr = 0;
-    std::string rv;
+    bool first = true;
     for (auto& v : value)
     {
-        rv += (cntr++ ? separator : "") + toStr(v, mode);
+        if (!first)
+            out.append(separator);
+        first = false;
+        appendTo(out, v, mode);
     }
+}
+
+// convert container to joined string
+template <class T>
+std::string join(const T& value, std::string_view separator/* = ", "*/, int mode /*= ENUM_TOSTR_REPR*/)
+{
+    std::string rv;
+    appendJoin(rv, value, separator, mode);
     return rv;
 }
 
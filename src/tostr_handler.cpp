@@ -8,13 +8,12 @@
 
 #include "tostr_fmt_include.h"
 #include "tostr.h"
+#include <charconv>
+#include <cstdint>
 #include <unordered_map>
 
 using namespace std;
 
-#define STRINGIZE_DETAIL(x) #x
-#define STRINGIZE(x) STRINGIZE_DETAIL(x)
-
 namespace tsv::util::tostr
 {
 
@@ -29,52 +28,48 @@ bool showEnumInteger = true;	// "ns::enum::valName" (0) or "ns::enum::valName(in
 
 }  // namespace tsv::util::tostr::settings
 
-namespace
-{
-std::string_view findPrefix(std::string_view base)
+/*********** Special cases of appendTo() *************/
+
+// Special case: const char*
+void appendTo( std::string& out, const char* v, int mode )
 {
-    std::string_view::size_type pos = base.find("(");
-    return base.substr(0,pos); 
+    if ( !v )
+        out.append( "nullptr" );
+    else
+        impl::__appendString( out, v, mode );
 }
 
-bool startsWith(std::string_view base, std::string_view lookup )
+// Special case: void*
+void appendTo( std::string& out, void* v, int )
 {
-    return ( base.size() >= lookup.size() ) && (base.substr(0,lookup.size()) == lookup );
+    appendHexAddr( out, v );
 }
-} // anonymous namespace
 
-bool Printer::detectNested(std::string_view base)
+// Special case: nullptr
+void appendTo( std::string& out, std::nullptr_t /*value*/, int /*mode*/ )
 {
-    static std::string prefixPrinter { findPrefix(STRINGIZE(TOSTR_JOIN())) };
-    static std::string_view prefixFmt1 = "fmt::format(";
-    static std::string_view prefixFmt2 = "std::format(";
-    return (startsWith(base, prefixPrinter) || startsWith(base, prefixFmt1)
-            || startsWith(base, prefixFmt2));
+    out.append( "nullptr" );
 }
 
-
-/*********** Special cases of toStr() *************/
-
-// Special case: const char*
 std::string toStr( const char* v, int mode )
 {
-    if ( !v )
-        return "nullptr";
-    if ( mode == ENUM_TOSTR_DEFAULT )
-        return std::string(v);
-    return "\"" + std::string(v) + "\"";
+    std::string rv;
+    appendTo( rv, v, mode );
+    return rv;
 }
 
-// Special case: void*
-std::string toStr(void* v, int)
+std::string toStr( void* v, int mode )
 {
-    return hex_addr(v);
+    std::string rv;
+    appendTo( rv, v, mode );
+    return rv;
 }
 
-// Special case: nullptr
-std::string toStr(std::nullptr_t /*value*/, int /*mode*/)
+std::string toStr( std::nullptr_t value, int mode )
 {
-    return "nullptr";
+    std::string rv;
+    appendTo( rv, value, mode );
+    return rv;
 }
 
 /*********** BEGIN OF namespace impl *************/
@@ -113,17 +108,84 @@ std::string __toStringLongHex(long value)
     return TOSTR_FMT("{:#x}", value);
 }
 
+void __appendInteger(std::string& out, unsigned long long value, bool hex)
+{
+    char buf[24];
+    if ( hex )
+        out.append( "0x" );
+    auto* end = std::to_chars( buf, buf + sizeof(buf), value, hex ? 16 : 10 ).ptr;
+    out.append( buf, end );
+}
+
+void __appendInteger(std::string& out, long long value, bool hex)
+{
+    if ( value >= 0 )
+        return __appendInteger( out, static_cast<unsigned long long>(value), hex );
+    if ( !hex )
+    {
+        char buf[24];
+        auto* end = std::to_chars( buf, buf + sizeof(buf), value ).ptr;
+        out.append( buf, end );
+        return;
+    }
+    // "-0x1" as fmt does
+    out.push_back( '-' );
+    __appendInteger( out, 0ULL - static_cast<unsigned long long>(value), hex );
+}
+
+// Same as std::to_string() ("%f"), but without temporary string
+void __appendFloat(std::string& out, double value)
+{
+#if defined(__cpp_lib_to_chars)
+    // Up to 309 digits of integral part + 6 of fractional one
+    char buf[330];
+    auto rv = std::to_chars( buf, buf + sizeof(buf), value, std::chars_format::fixed, 6 );
+    if ( rv.ec == std::errc() )
+    {
+        out.append( buf, rv.ptr );
+        return;
+    }
+#endif
+    out.append( std::to_string(value) );
+}
+
+void __appendFloat(std::string& out, long double value)
+{
+    out.append( std::to_string(value) );
+}
+
+void __appendString(std::string& out, std::string_view value, int mode)
+{
+    if ( mode == ENUM_TOSTR_DEFAULT )
+    {
+        out.append( value );
+        return;
+    }
+    out.push_back( '"' );
+    out.append( value );
+    out.push_back( '"' );
+}
+
 } // namespace impl
 
 
 
 //Get pointer hex representation
 std::string hex_addr(const void* ptr)
+{
+    std::string rv;
+    appendHexAddr(rv, ptr);
+    return rv;
+}
+
+void appendHexAddr(std::string& out, const void* ptr)
 {
     if ( !ptr )
-        return "nullptr";
-    else
-        return fmt::format("{}", ptr);
+    {
+        out.append( "nullptr" );
+        return;
+    }
+    impl::__appendInteger( out, static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(ptr)), true );
 }
 }   // 
 
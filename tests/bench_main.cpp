@@ -0,0 +1,204 @@
+/**
+ * Microbenchmarks of the hot paths
+ *   Usage: bench [iterations]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
+#define DEBUG_LOGGING 1
+#include "debuglog.h"
+#include "debuglog_settings.h"
+#include "debugresolve.h"
+#include "tostr_fmt_include.h"
+
+namespace tsv::debuglog::bench
+{
+
+void nullHandler(SentryLogger::Level, SentryLogger::Kind, std::string_view)
+{
+}
+
+int sink = 0;
+
+// Forbid compiler to hoist the checks out of the loop
+inline void clobber()
+{
+    asm volatile("" ::: "memory");
+}
+
+template <typename Fn>
+void measure(std::string_view name, long iterations, Fn&& fn)
+{
+    fn(iterations / 100 + 1);  // warm up
+    auto start = std::chrono::steady_clock::now();
+    fn(iterations);
+    auto finish = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    std::cout << TOSTR_FMT("{:<40} {:>10.2f} ns/op\n", name, ns / iterations);
+}
+
+[[gnu::noinline]] void disabledByLevel(long n)
+{
+    SENTRY_SILENT("bench");
+    SENTRYLOGGER_DO(setLogLevel)(SentryLogger::Level::Trace);
+    for (long i = 0; i < n; i++)
+    {
+        SAY_ARGS(i, sink);
+        clobber();
+    }
+}
+
+[[gnu::noinline]] void disabledByKind(long n)
+{
+    SENTRY_SILENT("bench", true, SentryLogger::Kind::TestOff);
+    SENTRYLOGGER_DO(setLogLevel)(SentryLogger::Level::Warning);
+    for (long i = 0; i < n; i++)
+    {
+        SAY_ARGS(i, sink);
+        clobber();
+    }
+}
+
+[[gnu::noinline]] void disabledNoScope(long n)
+{
+    for (long i = 0; i < n; i++)
+    {
+        SAY_ARGS_L(SentryLogger::Level::Trace, i, sink);
+        clobber();
+    }
+}
+
+[[gnu::noinline]] void suppressedByThrottle(long n)
+{
+    SENTRY_SILENT("bench");
+    SENTRYLOGGER_DO(setLogLevel)(SentryLogger::Level::Warning);
+    for (long i = 0; i < n; i++)
+    {
+        SAY_ARGS_THROTTLED(firstN(0), i, sink);
+        clobber();
+    }
+}
+
+[[gnu::noinline]] void disabledBySite(long n)
+{
+    SENTRY_SILENT("bench");
+    SENTRYLOGGER_DO(setLogLevel)(SentryLogger::Level::Warning);
+    for (long i = 0; i < n; i++)
+    {
+        SAY_ARGS(i, sink);
+        clobber();
+    }
+}
+
+[[gnu::noinline]] void capturedByRecorder(long n)
+{
+    SENTRY_SILENT("bench");
+    SENTRYLOGGER_DO(setLogLevel)(SentryLogger::Level::Trace);
+    for (long i = 0; i < n; i++)
+    {
+        SAY_DBG("captured line of the constant text");
+        clobber();
+    }
+}
+
+[[gnu::noinline]] void scope()
+{
+    SENTRY_FUNC();
+    clobber();
+}
+
+[[gnu::noinline]] void enabledScope(long n)
+{
+    for (long i = 0; i < n; i++)
+        scope();
+}
+
+[[gnu::noinline]] void scopeOfDisabledKind()
+{
+    SENTRY_FUNC({SentryLogger::Kind::TestOff});
+    clobber();
+}
+
+[[gnu::noinline]] void dormantScope(long n)
+{
+    for (long i = 0; i < n; i++)
+        scope();
+}
+
+[[gnu::noinline]] void dormantScopeByKind(long n)
+{
+    for (long i = 0; i < n; i++)
+        scopeOfDisabledKind();
+}
+
+[[gnu::noinline]] void namedScope()
+{
+    SENTRY_CONTEXT("bench");
+    clobber();
+}
+
+[[gnu::noinline]] void dormantNamedScope(long n)
+{
+    for (long i = 0; i < n; i++)
+        namedScope();
+}
+
+[[gnu::noinline]] void enabledNullHandler(long n)
+{
+    SENTRY_SILENT("bench");
+    SENTRYLOGGER_DO(setLogLevel)(SentryLogger::Level::Warning);
+    for (long i = 0; i < n; i++)
+    {
+        SAY_ARGS(i, sink);
+        clobber();
+    }
+}
+
+void run(long iterations)
+{
+    using Op = Settings::Operation;
+    Settings::setOutputHandler(nullHandler);
+    Settings::set({{SentryLogger::Level::Warning, Op::SetLogLevel},
+                   {SentryLogger::Kind::Default, true},
+                   {SentryLogger::Kind::TestOff, false}});
+
+    measure("SAY_ARGS disabled by level", iterations, disabledByLevel);
+    measure("SAY_ARGS disabled by kind", iterations, disabledByKind);
+    measure("SAY_ARGS_L disabled, no sentry in scope", iterations, disabledNoScope);
+    measure("SAY_ARGS_THROTTLED suppressed", iterations, suppressedByThrottle);
+    sites::set({"*", "*::disabledBySite"}, sites::State::Off);
+    measure("SAY_ARGS disabled by site", iterations, disabledBySite);
+    measure("SENTRY_FUNC disabled by level", iterations, dormantScope);
+    measure("SENTRY_FUNC disabled by kind", iterations, dormantScopeByKind);
+    measure("SENTRY_CONTEXT disabled by level", iterations, dormantNamedScope);
+    Settings::setCaptureLogLevel(SentryLogger::Level::Trace);
+    measure("SAY_DBG captured by flight recorder", iterations / 10, capturedByRecorder);
+    Settings::setCaptureLogLevel(SentryLogger::Level::Off);
+    measure("SAY_ARGS enabled, null handler", iterations / 100, enabledNullHandler);
+    Settings::setLogLevel(SentryLogger::Level::Info);
+    measure("SENTRY_FUNC enabled, null handler", iterations / 100, enabledScope);
+    Settings::setLogLevel(SentryLogger::Level::Warning);
+    measure("resolveAddr2Name by symbolizer", iterations / 1000, [](long n) {
+        for (long i = 0; i < n; i++)
+        {
+            sink += static_cast<int>(resolveAddr2Name(reinterpret_cast<const void*>(&enabledScope)).size());
+            clobber();
+        }
+    });
+    measure("empty loop", iterations, [](long n) {
+        for (long i = 0; i < n; i++)
+            clobber();
+    });
+}
+
+}  // namespace tsv::debuglog::bench
+
+int main(int argc, char** argv)
+{
+    long iterations = (argc > 1) ? std::atol(argv[1]) : 100000000;
+    tsv::debuglog::bench::run(iterations);
+    return 0;
+}
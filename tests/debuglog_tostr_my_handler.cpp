@@ -14,4 +14,11 @@ ToStringRV __toString(const tsv::debuglog::tests::KnownClass& value, int mode)
                :  "ExtAppearance#"+std::to_string(value.x)+"/"+std::to_string(value.y),
               true /*type match found*/};
 }
+
+bool __appendTo(std::string& out, const tsv::debuglog::tests::AppendedClass& value, int mode)
+{
+     out.append("Appended#");
+     __appendInteger(out, static_cast<long long>(value.x), mode == ENUM_TOSTR_REPR_HEX);
+     return true /*type match found*/;
+}
 }
@@ -9,6 +9,7 @@
 namespace tsv::debuglog::tests
 {
 struct KnownClass;
+struct AppendedClass;
 namespace objlog
 {
 struct TrackedItem;
@@ -25,6 +26,8 @@ namespace tsv::util::tostr::impl
 ToStringRV __toString(const tsv::debuglog::tests::KnownClass& value, int mode);
 ToStringRV __toString(const tsv::debuglog::tests::objlog::TrackedItem& value, int mode);
 ToStringRV __toString(const tsv::debuglog::tests::objlog::TrackedSimple& value, int mode);
+// The faster kind of handler which appends to the output instead of returning the string
+bool __appendTo(std::string& out, const tsv::debuglog::tests::AppendedClass& value, int mode);
 
 // Declare your own handlers here ...
 
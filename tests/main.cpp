@@ -255,6 +255,46 @@ namespace tsv::debuglog::tests::objlog
 {
 void run();
 }
+namespace tsv::debuglog::tests::test_async
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_stats
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_trace
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_throttle
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_sites
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_recorder
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_tail
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_alloc
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_symbols
+{
+void run();
+}
+namespace tsv::debuglog::tests::test_symcache
+{
+void run();
+}
 
 /**************** MAIN() ***************/
 int main()
@@ -271,6 +311,36 @@ int main()
 
     std::cout<< "\n *** OBJLOG module ***\n";
     tsv::debuglog::tests::objlog::run();
+
+    std::cout<< "\n *** DEBUGLOG module - ASYNC OUTPUT ***\n";
+    tsv::debuglog::tests::test_async::run();
+
+    std::cout<< "\n *** DEBUGLOG module - STATISTICS ***\n";
+    tsv::debuglog::tests::test_stats::run();
+
+    std::cout<< "\n *** DEBUGLOG module - TRACE EXPORT ***\n";
+    tsv::debuglog::tests::test_trace::run();
+
+    std::cout<< "\n *** DEBUGLOG module - THROTTLING ***\n";
+    tsv::debuglog::tests::test_throttle::run();
+
+    std::cout<< "\n *** DEBUGLOG module - CALL SITES ***\n";
+    tsv::debuglog::tests::test_sites::run();
+
+    std::cout<< "\n *** DEBUGLOG module - FLIGHT RECORDER ***\n";
+    tsv::debuglog::tests::test_recorder::run();
+
+    std::cout<< "\n *** DEBUGLOG module - TAIL BUFFERING ***\n";
+    tsv::debuglog::tests::test_tail::run();
+
+    std::cout<< "\n *** DEBUGLOG module - ALLOCATIONS ***\n";
+    tsv::debuglog::tests::test_alloc::run();
+
+    std::cout<< "\n *** DEBUGRESOLVE module - SYMBOLIZER ***\n";
+    tsv::debuglog::tests::test_symbols::run();
+
+    std::cout<< "\n *** DEBUGRESOLVE module - PERSISTENT CACHE ***\n";
+    tsv::debuglog::tests::test_symcache::run();
 /*
     std::cout<< "\n *** DEBUGWATCH module ***\n";
     test_watcher();
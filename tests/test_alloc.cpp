@@ -0,0 +1,144 @@
+/**
+ * Tests that the steady-state output path doesn't allocate
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up handler and other settings
+#include "debuglog_settings.h"
+
+#include "main.h"
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+// Heap allocations done by the current thread
+thread_local std::size_t allocations_t = 0;
+}
+
+// Replaced for the whole test binary, but only counts
+void* operator new(std::size_t size)
+{
+    allocations_t++;
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace tsv::debuglog::tests::test_alloc
+{
+
+std::size_t lines = 0;
+
+// Doesn't allocate itself
+void countingHandler(SentryLogger::Level, SentryLogger::Kind, std::string_view line)
+{
+    if (!line.empty())
+        lines++;
+}
+
+void testScope()
+{
+    SENTRY_FUNC();
+    SAY_DBG("constant text");
+}
+
+void testTimer()
+{
+    SENTRY_FUNC({/*.kind=*/SentryLogger::Kind::Default,
+                 /*.level=*/SentryLogger::Level::Default,
+                 /*.flags=*/SentryLogger::Flags::Timer});
+}
+
+void testArgs(int x)
+{
+    SENTRY_SILENT("args");
+    SAY_ARGS(x);
+}
+
+void testArgsOnly(int x)
+{
+    SENTRY_SILENT("args");
+    auto str = TOSTR_ARGS(x);
+}
+
+void testDeferred(int x)
+{
+    SENTRY_SILENT("deferred");
+    SAY_ARGS_DEFERRED(x);
+    SAY_FMT_DEFERRED("x={}", x);
+}
+
+// Lines are collected by the tail buffer and dropped at the scope end
+void testDeferredTail(int x)
+{
+    SENTRY_FUNC({/*.kind=*/SentryLogger::Kind::Default,
+                 /*.level=*/SentryLogger::Level::Default,
+                 /*.flags=*/SentryLogger::Flags::TailBuffer});
+    SAY_ARGS_DEFERRED(x);
+}
+
+void testStackTrace()
+{
+    SENTRY_FUNC();
+    SAY_STACKTRACE({/*.depth=*/2, /*.skip=*/0, /*.enforce=*/true});
+}
+
+// Allocations done by `fn` after the warm-up (first calls intern names and grow reused buffers)
+template <typename Fn>
+std::size_t countAllocations(Fn&& fn)
+{
+    fn();
+    auto before = allocations_t;
+    for (int i = 0; i < 10; i++)
+        fn();
+    return allocations_t - before;
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+    Settings::setOutputHandler(countingHandler);
+
+    auto scope = countAllocations([] { testScope(); });
+    auto timer = countAllocations([] { testTimer(); });
+    // Rendering of the arguments is not a part of the output path
+    auto args = countAllocations([] { testArgs(1); });
+    auto argsOnly = countAllocations([] { testArgsOnly(1); });
+    auto printed = lines;
+    auto deferred = countAllocations([] { testDeferred(1); });
+    auto deferredLines = lines - printed;
+    auto deferredTail = countAllocations([] { testDeferredTail(1); });
+    // Resolving of the frames is not a part of the output path too (its caches are warmed up by the first call),
+    // so it is measured without the output handler
+    resolve::settings::btEnable = true;
+    auto linesBefore = lines;
+    auto stackTrace = countAllocations([] { testStackTrace(); });
+    bool stackTracePrinted = lines > linesBefore;
+    Settings::setOutputHandler(nullptr);
+    auto stackTraceOnly = countAllocations([] { testStackTrace(); });
+
+    setupDefault("tsv::debuglog::tests::");
+    test(std::to_string(printed), "66");
+    test(std::to_string(scope), "0");
+    test(std::to_string(timer), "0");
+    test(std::to_string(args - argsOnly), "0");
+    test(std::to_string(deferredLines), "22");
+    test(std::to_string(deferred), "0");
+    test(std::to_string(deferredTail), "0");
+    test(std::to_string(stackTracePrinted), "1");
+    test(std::to_string(stackTrace - stackTraceOnly), "0");
+}
+
+}  // namespace tsv::debuglog::tests::test_alloc
@@ -0,0 +1,175 @@
+/**
+ * Tests asynchronous output mode
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up handler and other settings
+#include "debuglog_settings.h"
+#include "debuglog_async.h"
+
+#include "main.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace tsv::debuglog::tests::test_async
+{
+
+void testNested(int x)
+{
+    SENTRY_FUNC()(x);
+    SAY_DBG("inside");
+}
+
+void testDeferred(int x, const std::string& s)
+{
+    SENTRY_FUNC();
+    SAY_ARGS("Test ", x, s, 2.5);
+    // Only raw values are copied, text is produced by the writer thread
+    SAY_ARGS_DEFERRED("Test ", x, s, 2.5);
+    SAY_FMT_DEFERRED("x={} s={} flag={}", x, s, x > 0);
+}
+
+void testBadFormat(int x)
+{
+    SENTRY_FUNC();
+    SAY_FMT_DEFERRED("x={} y={}", x);
+}
+
+// Handler which stalls the writer on the first line until release() is called
+struct GatedHandler
+{
+    static inline std::mutex mutex;
+    static inline std::condition_variable cv;
+    static inline bool entered = false;
+    static inline bool released = false;
+
+    static void handler(SentryLogger::Level level, SentryLogger::Kind kind, std::string_view line)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        entered = true;
+        cv.notify_all();
+        cv.wait(lock, [] { return released; });
+        testLoggerHandlerSentry(level, kind, line);
+    }
+
+    static void waitEntered()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [] { return entered; });
+    }
+
+    static void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+        cv.notify_all();
+    }
+
+    static void reset()
+    {
+        entered = false;
+        released = false;
+    }
+};
+
+void testOverflow(async::Overflow policy)
+{
+    GatedHandler::reset();
+    Settings::setOutputHandler(GatedHandler::handler);
+    async::start({/*.bufferSize=*/4, policy});
+
+    SAY_DBG("line 1");
+    // Now the writer is stuck in the handler, so buffer gets overflowed
+    GatedHandler::waitEntered();
+    for (int i = 2; i <= 10; i++)
+        SAY_ARGS("line", i);
+    GatedHandler::release();
+
+    async::stop();
+    Settings::setOutputHandler(testLoggerHandlerSentry);
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+
+    async::start({/*.bufferSize=*/16, async::Overflow::Block});
+    testNested(1);
+    // Nothing is written until the writer thread do it
+    async::flush();
+    TEST(
+        "[Info:Dflt]01>{test_async::testNested}>> Enter x = 1\n"
+        "[Info:Dflt]01 {test_async::testNested}inside\n"
+        "[Info:Dflt]01<{test_async::testNested}>> Leave scope\n"
+        );
+
+    // Block policy never loses lines even if the buffer is much less than amount of lines
+    std::thread worker([] {
+        for (int i = 0; i < 100; i++)
+            testNested(i);
+    });
+    worker.join();
+    async::flush();
+    test(std::to_string(std::count(loggedString.begin(), loggedString.end(), '\n')), "300");
+    loggedString.clear();
+
+    testDeferred(3, "temporary");
+    async::flush();
+    TEST(
+        "[Info:Dflt]01>{test_async::testDeferred}>> Enter scope\n"
+        "[Info:Dflt]01 {test_async::testDeferred}Test  x = 3, s = \"temporary\"2.500000\n"
+        "[Info:Dflt]01 {test_async::testDeferred}Test  x = 3, s = \"temporary\"2.500000\n"
+        "[Info:Dflt]01 {test_async::testDeferred}x=3 s=temporary flag=true\n"
+        "[Info:Dflt]01<{test_async::testDeferred}>> Leave scope\n"
+        );
+
+    // Malformed format doesn't kill the writer thread
+    testBadFormat(5);
+    async::flush();
+    test(std::to_string(loggedString.find("{test_async::testBadFormat}[debuglog] bad format \"x={} y={}\" at ")
+                        != std::string::npos), "1");
+    loggedString.clear();
+    async::stop();
+
+    // Not active anymore, so written immediately
+    testDeferred(4, "sync");
+    TEST(
+        "[Info:Dflt]01>{test_async::testDeferred}>> Enter scope\n"
+        "[Info:Dflt]01 {test_async::testDeferred}Test  x = 4, s = \"sync\"2.500000\n"
+        "[Info:Dflt]01 {test_async::testDeferred}Test  x = 4, s = \"sync\"2.500000\n"
+        "[Info:Dflt]01 {test_async::testDeferred}x=4 s=sync flag=true\n"
+        "[Info:Dflt]01<{test_async::testDeferred}>> Leave scope\n"
+        );
+
+    testNested(2);
+    TEST(
+        "[Info:Dflt]01>{test_async::testNested}>> Enter x = 2\n"
+        "[Info:Dflt]01 {test_async::testNested}inside\n"
+        "[Info:Dflt]01<{test_async::testNested}>> Leave scope\n"
+        );
+
+    testOverflow(async::Overflow::DropNewest);
+    TEST(
+        "[Warn:Dflt]00 {core}line 1\n"
+        "[Warn:Dflt]00 {core}line i = 2\n"
+        "[Warn:Dflt]00 {core}line i = 3\n"
+        "[Warn:Dflt]00 {core}line i = 4\n"
+        "[Warn:Dflt]00 {core}line i = 5\n"
+        "[Warn:Dflt][debuglog] 5 records dropped\n"
+        );
+
+    testOverflow(async::Overflow::DropOldest);
+    TEST(
+        "[Warn:Dflt]00 {core}line 1\n"
+        "[Warn:Dflt]00 {core}line i = 7\n"
+        "[Warn:Dflt]00 {core}line i = 8\n"
+        "[Warn:Dflt]00 {core}line i = 9\n"
+        "[Warn:Dflt]00 {core}line i = 10\n"
+        "[Warn:Dflt][debuglog] 5 records dropped\n"
+        );
+}
+
+}  // namespace tsv::debuglog::tests::test_async
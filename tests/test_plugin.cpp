@@ -0,0 +1,8 @@
+/**
+ * Library loaded by dlopen() in the symbolizer tests
+ */
+
+extern "C" [[gnu::noinline]] int debuglogTestPluginFunction(int x)
+{
+    return x * 3 + 1;
+}
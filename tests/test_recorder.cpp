@@ -0,0 +1,105 @@
+/**
+ * Tests flight recorder
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up handler and other settings
+#include "debuglog_settings.h"
+#include "debuglog_recorder.h"
+
+#include "main.h"
+#include <csignal>
+#include <thread>
+
+namespace tsv::debuglog::tests::test_recorder
+{
+
+void testWork(int x)
+{
+    SENTRY_FUNC({/*.kind=*/SentryLogger::Kind::Default, /*.level=*/SentryLogger::Level::Debug})(x);
+    SAY_DBG("detail");
+    SAY_FMT_DEFERRED("deferred {}", x);
+    // Temporary level is kept till the end of the scope
+    SAY_DBG_L(SentryLogger::Level::Info, "progress");
+}
+
+void testFailure()
+{
+    SENTRY_CONTEXT("failure");
+    SAY_DBG_L(SentryLogger::Level::Error, "failed");
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+
+    // Nothing is captured if the recorder is off
+    testWork(0);
+    TEST("[Info:Dflt]01 {test_recorder::testWork}progress\n");
+    test(std::to_string(recorder::dump()), "0");
+
+    Settings::setCaptureLogLevel(SentryLogger::Level::Debug);
+    test(std::to_string(static_cast<int>(Settings::getCaptureLogLevel())), "5");
+    test(std::to_string(static_cast<int>(Settings::getLogLevel())), "4");
+
+    // Debug leave message passes the hot check now and is printed with the temporary level
+    testWork(1);
+    TEST(
+        "[Info:Dflt]01 {test_recorder::testWork}progress\n"
+        "[Info:Dflt]01<{test_recorder::testWork}>> Leave scope\n"
+        );
+
+    // Error line prints captured lines first
+    testFailure();
+    TEST(
+        "[Info:Dflt]01>{failure}>> Enter scope\n"
+        "[Warn:Dflt]00 {recorder}[debuglog] flight recorder: last 3 records\n"
+        "[:Dflt]01>{test_recorder::testWork}>> Enter x = 1\n"
+        "[:Dflt]01 {test_recorder::testWork}detail\n"
+        "[:Dflt]01 {test_recorder::testWork}deferred 1\n"
+        "[Err:Dflt]01 {failure}failed\n"
+        "[Err:Dflt]01<{failure}>> Leave scope\n"
+        );
+    // Records are dumped only once
+    test(std::to_string(recorder::dump()), "0");
+
+    // Ring keeps only the last records
+    recorder::configure({/*.recordsPerThread=*/3});
+    std::thread worker([] {
+        for (int i = 0; i < 3; i++)
+            testWork(i + 10);
+    });
+    worker.join();
+    loggedString.clear();
+    test(std::to_string(recorder::dump()), "3");
+    TEST(
+        "[Warn:Dflt]00 {recorder}[debuglog] flight recorder: last 3 records\n"
+        "[:Dflt]01>{test_recorder::testWork}>> Enter x = 12\n"
+        "[:Dflt]01 {test_recorder::testWork}detail\n"
+        "[:Dflt]01 {test_recorder::testWork}deferred 12\n"
+        );
+
+    // Dump by signal is done by the next printed line
+    test(std::to_string(recorder::installSignalHandler(SIGUSR2)), "1");
+    testWork(2);
+    loggedString.clear();
+    std::raise(SIGUSR2);
+    SAY_DBG_L(SentryLogger::Level::Info, "next");
+    TEST(
+        "[Warn:Dflt]00 {recorder}[debuglog] flight recorder: last 3 records\n"
+        "[:Dflt]01>{test_recorder::testWork}>> Enter x = 2\n"
+        "[:Dflt]01 {test_recorder::testWork}detail\n"
+        "[:Dflt]01 {test_recorder::testWork}deferred 2\n"
+        "[Info:Dflt]00 {core}next\n"
+        );
+    std::signal(SIGUSR2, SIG_DFL);
+
+    recorder::configure({});
+    Settings::setCaptureLogLevel(SentryLogger::Level::Off);
+    testWork(3);
+    TEST("[Info:Dflt]01 {test_recorder::testWork}progress\n");
+    test(std::to_string(recorder::dump()), "0");
+}
+
+}  // namespace tsv::debuglog::tests::test_recorder
@@ -23,7 +23,10 @@
 #include "test_tostr.h"
 #include "tostr_fmt_include.h"
 #include "main.h"
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <pthread.h>
 
 namespace tsv::debuglog::tests
 {
@@ -191,6 +194,44 @@ void testAppend()
                  /*.flags=*/SentryLogger::Flags::AppendContextName});
 }
 
+void testContextNames(const std::string& name)
+{
+    SENTRY_CONTEXT(name);
+    SAY_DBG("dynamic");
+    {
+        SENTRY_CONTEXT("child", {/*.kind=*/SentryLogger::Kind::Default,
+                                 /*.level=*/SentryLogger::Level::Default,
+                                 /*.flags=*/static_cast<SentryLogger::Flags>(SentryLogger::Flags::SuppressBorders
+                                                                             | SentryLogger::Flags::AppendContextName)});
+        SAY_DBG("appended");
+    }
+}
+
+void testFuncName()
+{
+    SENTRY_FUNC();
+}
+
+void testLineLayout()
+{
+    SENTRY_CONTEXT("layout");
+    SAY_DBG("text");
+}
+
+void testDormantSentry()
+{
+    // Trace level is out of the log level, so the sentries are created by the fast path
+    SENTRY_CONTEXT("dormant", {/*.kind=*/SentryLogger::Kind::Default, /*.level=*/SentryLogger::Level::Trace});
+    SAY_DBG("hidden");
+    {
+        SENTRY_CONTEXT("woken", {/*.kind=*/SentryLogger::Kind::Default, /*.level=*/SentryLogger::Level::Trace});
+        SENTRYLOGGER_DO(setLogLevel)(SentryLogger::Level::Info);
+        SAY_DBG("awake");
+    }
+    SENTRYLOGGER_DO(setLogLevel)(SentryLogger::Level::Info);
+    SAY_DBG("after");
+}
+
 void testDisabledSentry(int arg)
 {
     /* In C++20 we can define just .enable= with designated initializer*/
@@ -302,6 +343,62 @@ void testTimerSentry()
     // timer of sentry 1 still on, so report on exit
 }
 
+void testThreads()
+{
+    SENTRY_CONTEXT("testThreads");
+
+    // Each thread has own stack of sentries, so nesting level and
+    // context of the worker do not depend on the sentries of this thread
+    std::thread worker([] {
+        testRawCall();
+        testTrivial();
+    });
+    worker.join();
+
+    SAY_DBG("joined");
+}
+
+void testConcurrentSettings()
+{
+    using Op = Settings::Operation;
+
+    // Settings are changed while other thread logs. Each batch is published at once,
+    // so the reader sees either the whole batch or nothing of it.
+    std::atomic<bool> done{false};
+    std::thread writer([&done] {
+        for (int i = 0; i < 2000; i++)
+        {
+            Settings::TemporarySettings tmp({{SentryLogger::Kind::Default, false},
+                                             {SentryLogger::Level::Warning, Op::SetLogLevel}});
+        }
+        done = true;
+    });
+    int count = 0;
+    while (!done)
+    {
+        SENTRY_CONTEXT("concurrent");
+        SAY_DBG("line");
+        count++;
+    }
+    writer.join();
+
+    // The every printed line is complete
+    bool isOk = true;
+    std::string_view rest = loggedString;
+    while (!rest.empty())
+    {
+        auto pos = rest.find('\n');
+        auto line = rest.substr(0, pos);
+        isOk = isOk && (line == "[Info:Dflt]01>{concurrent}>> Enter scope"
+                        || line == "[Info:Dflt]01 {concurrent}line"
+                        || line == "[Info:Dflt]01<{concurrent}>> Leave scope");
+        rest.remove_prefix(pos + 1);
+    }
+    loggedString.clear();
+    test(isOk ? "ok" : "broken line", "ok");
+    SAY_ARGS_L(SentryLogger::Level::Warning, "after", count > 0);
+}
+
 void run()
 {
     using Op = Settings::Operation;
@@ -478,6 +575,91 @@ void run()
         "[Info:Dflt]01<{testTimer1}>> Leave scope. Processing time = 0.0000s\n"
     );
 
+    testThreads();
+    TEST(
+        "[Info:Dflt]01>{testThreads}>> Enter scope\n"
+        // worker thread has no sentries yet, so it refers to the "core" sentry and starts from level 0
+        "[Warn:Dflt]00 {core}Test  x = 11\n"
+        "[Info:Dflt]01>{test_sentry1::testTrivial}>> Enter scope\n"
+        "[Info:Dflt]01 {test_sentry1::testTrivial}test\n"
+        "[Info:Dflt]01<{test_sentry1::testTrivial}>> Leave scope\n"
+        "[Info:Dflt]01 {testThreads}joined\n"
+        "[Info:Dflt]01<{testThreads}>> Leave scope\n"
+    );
+
+    testConcurrentSettings();
+    TEST(
+        // settings are rolled back to their initial state
+        "[Warn:Dflt]00 {core}after count > 0 = true\n"
+    );
+
+    // Context names are interned, so the reused buffer with other content gives other name
+    std::string name = "first";
+    testContextNames(name);
+    name = "other";
+    testContextNames(name);
+    TEST(
+        "[Info:Dflt]01>{first}>> Enter scope\n"
+        "[Info:Dflt]01 {first}dynamic\n"
+        "[Info:Dflt]02  {first--child}appended\n"
+        "[Info:Dflt]01<{first}>> Leave scope\n"
+        "[Info:Dflt]01>{other}>> Enter scope\n"
+        "[Info:Dflt]01 {other}dynamic\n"
+        "[Info:Dflt]02  {other--child}appended\n"
+        "[Info:Dflt]01<{other}>> Leave scope\n"
+    );
+
+    // Parts of the line in any order
+    using LineField = Settings::LineField;
+    auto layout = Settings::getLineLayout();
+    Settings::setLineLayout({LineField::Level, LineField::Context, LineField::Body});
+    testLineLayout();
+    Settings::setLineLayout({LineField::Body, LineField::Nested});
+    testLineLayout();
+    // Name of the thread is taken once per thread, so it is set before the first line
+    Settings::setLineLayout({LineField::ThreadName, LineField::Body});
+    std::thread named([] {
+        ::pthread_setname_np(::pthread_self(), "layout-worker");
+        testLineLayout();
+    });
+    named.join();
+    Settings::setLineLayout(layout);
+    TEST(
+        "[Info:Dflt]INFO {layout}>> Enter scope\n"
+        "[Info:Dflt]INFO {layout}text\n"
+        "[Info:Dflt]INFO {layout}>> Leave scope\n"
+        "[Info:Dflt]>> Enter scope01>\n"
+        "[Info:Dflt]text01 \n"
+        "[Info:Dflt]>> Leave scope01<\n"
+        "[Info:Dflt][layout-worker] >> Enter scope\n"
+        "[Info:Dflt][layout-worker] text\n"
+        "[Info:Dflt][layout-worker] >> Leave scope\n"
+    );
+
+    // Sentries out of the log level are on the stack, and print lines after the level is raised
+    testDormantSentry();
+    TEST(
+        "[Info:Dflt]02  {woken}awake\n"
+        "[Info:Dflt]02<<{woken}>> Leave scope\n"
+        "[Info:Dflt]01 {dormant}after\n"
+        "[Info:Dflt]01<{dormant}>> Leave scope\n"
+    );
+
+    // Cached names of functions are dropped when the cut namespaces are changed
+    testFuncName();
+    Settings::setCutoffNamespaces({"tsv::debuglog::"});
+    testFuncName();
+    Settings::setCutoffNamespaces({"tsv::debuglog::tests::"});
+    testFuncName();
+    TEST(
+        "[Info:Dflt]01>{test_sentry1::testFuncName}>> Enter scope\n"
+        "[Info:Dflt]01<{test_sentry1::testFuncName}>> Leave scope\n"
+        "[Info:Dflt]01>{tests::test_sentry1::testFuncName}>> Enter scope\n"
+        "[Info:Dflt]01<{tests::test_sentry1::testFuncName}>> Leave scope\n"
+        "[Info:Dflt]01>{test_sentry1::testFuncName}>> Enter scope\n"
+        "[Info:Dflt]01<{test_sentry1::testFuncName}>> Leave scope\n"
+    );
+
 //@todo -why doesn't print kind?? because map is not initialized. do that via settings vector<pair<>>
 }
 
@@ -0,0 +1,131 @@
+/**
+ * Tests runtime per-site switches of SENTRY_* / SAY_*
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up handler and other settings
+#include "debuglog_settings.h"
+
+#include "main.h"
+#include <algorithm>
+
+namespace tsv::debuglog::tests::test_sites
+{
+
+void testLines(int x)
+{
+    SENTRY_FUNC()(x);
+    SAY_DBG("first");
+    SAY_DBG_L(SentryLogger::Level::Debug, "debug");
+    SAY_ARGS(x);
+}
+
+void testContext()
+{
+    SENTRY_CONTEXT("ctx");
+    SAY_DBG("body");
+}
+
+// Registered sites of this file in order of lines
+std::string listSites()
+{
+    auto sites = sites::list();
+    std::sort(sites.begin(), sites.end(), [](const auto& a, const auto& b) { return a.line < b.line; });
+    std::string rv;
+    for (const auto& site : sites)
+    {
+        if (site.file.find("test_sites.cpp") == std::string::npos)
+            continue;
+        rv += TOSTR_FMT("{} {} {}\n", site.line, extractFuncName(site.function), static_cast<int>(site.state));
+    }
+    return rv;
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+
+    // Sites are not known until they are executed
+    test(listSites(), "");
+
+    testLines(1);
+    TEST(
+        "[Info:Dflt]01>{test_sites::testLines}>> Enter x = 1\n"
+        "[Info:Dflt]01 {test_sites::testLines}first\n"
+        "[Info:Dflt]01 {test_sites::testLines}x = 1\n"
+        "[Info:Dflt]01<{test_sites::testLines}>> Leave scope\n"
+        );
+    test(listSites(),
+         "18 tsv::debuglog::tests::test_sites::testLines 1\n"
+         "19 tsv::debuglog::tests::test_sites::testLines 1\n"
+         "20 tsv::debuglog::tests::test_sites::testLines 1\n"
+         "21 tsv::debuglog::tests::test_sites::testLines 1\n");
+
+    // Turn off single line and turn on the line which is out of the log level
+    test(std::to_string(sites::set({"*/test_sites.cpp", "*::testLines", 19, 19}, sites::State::Off)), "1");
+    test(std::to_string(sites::set({"*test_sites.cpp", "*", 20, 20}, sites::State::On)), "1");
+    testLines(2);
+    TEST(
+        "[Info:Dflt]01>{test_sites::testLines}>> Enter x = 2\n"
+        "[Info:Dflt]01 {test_sites::testLines}debug\n"
+        "[Info:Dflt]01 {test_sites::testLines}x = 2\n"
+        "[Info:Dflt]01<{test_sites::testLines}>> Leave scope\n"
+        );
+
+    // Forced site ignores state of the kind, the rest of the sentry is not printed
+    {
+        Settings::TemporarySettings tmp({{SentryLogger::Kind::Default, false}});
+        testLines(3);
+    }
+    TEST("[Info:Dflt]01 {test_sites::testLines}debug\n");
+
+    // Rules are applied to the sites registered later
+    test(std::to_string(sites::set({"*", "*::testContext"}, sites::State::Off)), "0");
+    testContext();
+    TEST("");
+    // Forced line is printed even inside of turned off sentry
+    test(std::to_string(sites::set({"*", "*::testContext", 27, 27}, sites::State::On)), "1");
+    testContext();
+    TEST("[Info:Dflt]01 {ctx}body\n");
+    test(std::to_string(sites::set({"*", "*::testContext", 26, 26}, sites::State::On)), "1");
+    {
+        Settings::TemporarySettings tmp({{SentryLogger::Kind::Default, false}});
+        testContext();
+    }
+    TEST(
+        "[Info:Dflt]01>{ctx}>> Enter scope\n"
+        "[Info:Dflt]01 {ctx}body\n"
+        "[Info:Dflt]01<{ctx}>> Leave scope\n"
+        );
+    // Forced sentry doesn't force lines in its scope
+    test(std::to_string(sites::set({"*", "*::testContext", 27, 27}, sites::State::Default)), "1");
+    {
+        Settings::TemporarySettings tmp({{SentryLogger::Kind::Default, false}});
+        testContext();
+    }
+    TEST(
+        "[Info:Dflt]01>{ctx}>> Enter scope\n"
+        "[Info:Dflt]01<{ctx}>> Leave scope\n"
+        );
+
+    // Later rule wins
+    test(std::to_string(sites::set({"*test_sites.cpp", "*::testLines"}, sites::State::Off)), "4");
+    testLines(4);
+    TEST("");
+    test(std::to_string(sites::set({"*test_sites.cpp", "*::testLines", 18, 18}, sites::State::Default)), "1");
+    testLines(5);
+    TEST("[Info:Dflt]01>{test_sites::testLines}>> Enter x = 5\n"
+         "[Info:Dflt]01<{test_sites::testLines}>> Leave scope\n");
+
+    sites::reset();
+    testLines(6);
+    TEST(
+        "[Info:Dflt]01>{test_sites::testLines}>> Enter x = 6\n"
+        "[Info:Dflt]01 {test_sites::testLines}first\n"
+        "[Info:Dflt]01 {test_sites::testLines}x = 6\n"
+        "[Info:Dflt]01<{test_sites::testLines}>> Leave scope\n"
+        );
+}
+
+}  // namespace tsv::debuglog::tests::test_sites
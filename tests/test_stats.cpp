@@ -0,0 +1,100 @@
+/**
+ * Tests aggregated timing statistics
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up handler and other settings
+#include "debuglog_settings.h"
+#include "debuglog_stats.h"
+
+#include "main.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace tsv::debuglog::tests::test_stats
+{
+
+void testStatsSentry(int x)
+{
+    SENTRY_FUNC({/*.kind=*/SentryLogger::Kind::Default,
+                 /*.level=*/SentryLogger::Level::Default,
+                 /*.flags=*/SentryLogger::Flags::Stats})(x);
+    SAY_DBG("inside");
+}
+
+void testSilentStats()
+{
+    // Borders are not printed, but statistics are collected
+    SENTRY_SILENT("silent");
+    SENTRYLOGGER_DO(setFlag)(SentryLogger::Flags::Stats);
+}
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+    stats::reset();
+
+    // Processing time is not printed for each call
+    testStatsSentry(1);
+    TEST(
+        "[Info:Dflt]01>{test_stats::testStatsSentry}>> Enter x = 1\n"
+        "[Info:Dflt]01 {test_stats::testStatsSentry}inside\n"
+        "[Info:Dflt]01<{test_stats::testStatsSentry}>> Leave scope\n"
+        );
+
+    // Samples from other threads are merged (even if the thread is finished)
+    std::thread worker([] {
+        for (int i = 0; i < 9; i++)
+            testStatsSentry(i);
+        testSilentStats();
+    });
+    worker.join();
+    loggedString.clear();
+    testSilentStats();
+
+    auto summaries = stats::collect();
+    test(std::to_string(summaries.size()), "2");
+    test(summaries[0].name + "=" + std::to_string(summaries[0].count), "silent=2");
+    test(summaries[1].name + "=" + std::to_string(summaries[1].count), "test_stats::testStatsSentry=10");
+    test(std::to_string(summaries[1].min <= summaries[1].p50 && summaries[1].p50 <= summaries[1].max), "1");
+
+    // Deterministic samples: 1..1000us
+    stats::reset();
+    for (std::uint64_t i = 1; i <= 1000; i++)
+        stats::record("manual", i * 1000);
+    stats::dump(SentryLogger::Level::Warning);
+    TEST(
+        // quantiles are upper bounds of the histogram buckets
+        "[Warn:Dflt]00 {stats}manual: count=1000 avg=500.500us min=1.000us p50=507.903us p90=917.503us "
+        "p99=1.000ms p999=1.000ms max=1.000ms\n"
+        );
+
+    std::string path = "test_stats.prom";
+    test(std::to_string(stats::writeOpenMetrics(path)), "1");
+    auto content = readFile(path);
+    std::remove(path.c_str());
+    test(content.substr(0, content.find("debuglog_scope_duration_seconds{")),
+         "# TYPE debuglog_scope_duration_seconds summary\n"
+         "# UNIT debuglog_scope_duration_seconds seconds\n"
+         "# HELP debuglog_scope_duration_seconds Duration of sentry scopes.\n");
+    test(std::to_string(content.find("debuglog_scope_duration_seconds{context=\"manual\",quantile=\"0.9\"} 0.000917503\n") != std::string::npos), "1");
+    test(std::to_string(content.find("debuglog_scope_duration_seconds_count{context=\"manual\"} 1000\n") != std::string::npos), "1");
+    test(std::to_string(content.find("debuglog_scope_duration_max_seconds{context=\"manual\"} 0.001\n") != std::string::npos), "1");
+    test(content.substr(content.size() - 6), "# EOF\n");
+
+    stats::reset();
+    test(std::to_string(stats::collect().size()), "0");
+}
+
+}  // namespace tsv::debuglog::tests::test_stats
@@ -0,0 +1,155 @@
+/**
+ * Tests in-process symbolizer
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up btEnable
+#include "debugresolve.h"
+#include "debugsymbols.h"
+
+#include "main.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace tsv::debuglog::tests::test_symbols
+{
+
+int sink = 0;
+
+[[gnu::noinline]] void targetFunction(int x)
+{
+    for (int i = 0; i < x; i++)
+        sink += i * x;
+}
+
+extern "C" [[gnu::noinline]] void debuglogTestCFunction()
+{
+    sink++;
+}
+
+[[gnu::noinline]] std::vector<std::string> traceHere()
+{
+    return getStackTrace(5);
+}
+
+// The whole body is on the line of the returned __LINE__
+[[gnu::noinline]] int lineFunction() { sink += 3; return __LINE__; }
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+    resolve::settings::btEnable = true;
+
+    auto* addr = reinterpret_cast<const void*>(&targetFunction);
+    auto* inside = static_cast<const char*>(addr) + 4;
+
+    symbols::Symbol symbol;
+    test(std::to_string(symbols::lookup(inside, symbol)), "1");
+    test(std::to_string(symbol.start == addr), "1");
+    test(symbol.name, "_ZN3tsv8debuglog5tests12test_symbols14targetFunctionEi");
+    test(std::string(symbols::functionName(addr)), "tsv::debuglog::tests::test_symbols::targetFunction(int)");
+    test(std::string(symbols::functionName(reinterpret_cast<const void*>(&debuglogTestCFunction))),
+         "debuglogTestCFunction");
+
+    // Shared objects are known as well
+    test(std::to_string(symbols::lookup(reinterpret_cast<const void*>(&::abort), symbol)), "1");
+    test(std::to_string(std::string(symbol.module).find("libc") != std::string::npos), "1");
+
+    test(std::to_string(symbols::lookup(nullptr, symbol)), "0");
+    symbols::reload();
+    test(std::string(symbols::functionName(inside)), "tsv::debuglog::tests::test_symbols::targetFunction(int)");
+
+    // Function name without line is resolved without addr2line
+    test(resolveAddr2Name(addr), "tsv::debuglog::tests::test_symbols::targetFunction(int)");
+    test(resolveAddr2Name(addr, false, true), "0xADDR tsv::debuglog::tests::test_symbols::targetFunction(int)", true);
+
+    // File and line are taken from DWARF line table
+    int expectedLine = lineFunction();
+    auto* lineAddr = reinterpret_cast<const void*>(&lineFunction);
+    std::string_view file;
+    int line = 0;
+    test(std::to_string(symbols::lookupLine(lineAddr, file, line)), "1");
+    test(std::to_string(line == expectedLine), "1");
+    test(std::to_string(std::string(file).rfind("tests/test_symbols.cpp") == file.size() - 22), "1");
+    std::string withLine = resolveAddr2Name(lineAddr, true);
+    test(withLine.substr(0, withLine.find(" at ")), "tsv::debuglog::tests::test_symbols::lineFunction()");
+    test(withLine.substr(withLine.rfind(':')), (":" + std::to_string(expectedLine)).c_str());
+    test(std::to_string(symbols::lookupLine(nullptr, file, line)), "0");
+
+    // Without symbolizer frames of the stack trace are asked from addr2line by one request.
+    // It is run per module with offsets inside of it, so PIE executable and libraries are known.
+    resolve::settings::btShortList = false;
+    traceHere();    // the first call detects own frames to skip - by names, so do it with symbolizer
+    resolve::settings::btUseSymbolizer = false;
+    withLine = resolveAddr2Name(lineAddr, true);
+    test(withLine.substr(0, withLine.find(" at ")), "tsv::debuglog::tests::test_symbols::lineFunction()");
+    test(withLine.substr(withLine.rfind(':')), (":" + std::to_string(expectedLine)).c_str());
+    test(resolveAddr2Name(reinterpret_cast<const void*>(&debuglogTestCFunction)), "debuglogTestCFunction");
+    auto trace = traceHere();
+    test(std::to_string(trace.size()), "3");     // till "main"
+    trace.resize(2);
+    test(std::to_string(trace[0].find("] tsv::debuglog::tests::test_symbols::traceHere[abi:cxx11]() at ") != std::string::npos), "1");
+    test(std::to_string(trace[1].find("] tsv::debuglog::tests::test_symbols::run() at ") != std::string::npos), "1");
+    test(std::to_string(traceHere().front() == trace.front()), "1");
+
+    // Concurrent requests share the pool of resolvers and get the same answers
+    std::atomic<int> same{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+        threads.emplace_back([&] {
+            same += resolveAddr2Name(lineAddr, true) == resolveAddr2Name(lineAddr, true);
+            same += resolveAddr2Name(addr) == resolveAddr2Name(addr);
+        });
+    for (auto& thread : threads)
+        thread.join();
+    test(std::to_string(same.load()), "8");
+
+    // JIT code is known from perf map
+    std::vector<char> jitCode(64);
+    std::string perfMap = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+    if (FILE* file = std::fopen(perfMap.c_str(), "w"))
+    {
+        std::fprintf(file, "%llx 40 jitted_function\n",
+                     static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(jitCode.data())));
+        std::fclose(file);
+    }
+    test(resolveAddr2Name(jitCode.data() + 8), "jitted_function");
+    resolve::settings::btUseSymbolizer = true;
+    test(std::string(symbols::functionName(jitCode.data() + 8)), "jitted_function");
+    test(std::to_string(symbols::lookup(jitCode.data() + 8, symbol) && symbol.module == perfMap), "1");
+    std::remove(perfMap.c_str());
+    // The file is checked for changes not on each lookup
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    test(std::to_string(symbols::lookup(jitCode.data() + 8, symbol)), "0");
+
+    // Library opened after the first lookup is found without explicit reload()
+    if (void* plugin = ::dlopen(DEBUGLOG_TEST_PLUGIN, RTLD_NOW | RTLD_LOCAL))
+    {
+        auto* pluginFunction = ::dlsym(plugin, "debuglogTestPluginFunction");
+        test(std::string(symbols::functionName(pluginFunction)), "debuglogTestPluginFunction");
+        symbols::Module module;
+        test(std::to_string(symbols::findModule(pluginFunction, module)
+                            && std::string(module.path).find("test_plugin") != std::string::npos), "1");
+        resolve::settings::btUseSymbolizer = false;
+        test(resolveAddr2Name(pluginFunction), "debuglogTestPluginFunction");
+        resolve::settings::btUseSymbolizer = true;
+    }
+    else
+        test(::dlerror(), "");
+    resolve::settings::btShortList = true;
+    resolve::settings::btUseSymbolizer = true;
+
+    setupDefault("tsv::debuglog::tests::");
+}
+
+}  // namespace tsv::debuglog::tests::test_symbols
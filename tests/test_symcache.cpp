@@ -0,0 +1,134 @@
+/**
+ * Tests persistent symbol cache
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up btEnable
+#include "debugresolve.h"
+#include "debugsymbols.h"
+#include "debugsymcache.h"
+
+#include "main.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+namespace tsv::debuglog::tests::test_symcache
+{
+
+int sink = 0;
+
+[[gnu::noinline]] void cachedFunction()
+{
+    sink++;
+}
+
+[[gnu::noinline]] void otherFunction()
+{
+    sink += 2;
+}
+
+[[gnu::noinline]] void symbolizedFunction()
+{
+    sink += 3;
+}
+
+std::string lookup(const void* addr)
+{
+    std::string funcName, path;
+    if (!symcache::find(addr, funcName, path))
+        return "{not found}";
+    return funcName + path;
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+    resolve::settings::btEnable = true;
+
+    char dirTemplate[] = "/tmp/debuglog_symcache_XXXXXX";
+    const char* dir = mkdtemp(dirTemplate);
+    resolve::settings::btCacheDir = std::string(dir ? dir : "/tmp") + "/cache";
+    test(symcache::directory(), (resolve::settings::btCacheDir).c_str());
+
+    auto* addr = reinterpret_cast<const void*>(&cachedFunction);
+    auto* other = reinterpret_cast<const void*>(&otherFunction);
+    symbols::Module module;
+    test(std::to_string(symbols::findModule(addr, module)), "1");
+    test(std::to_string(module.buildId.size() >= 16), "1");
+    std::string fileName = resolve::settings::btCacheDir + "/" + std::string(module.buildId) + ".symcache";
+
+    // Entries are visible before flush, but not stored
+    test(lookup(addr), "{not found}");
+    symcache::store(addr, "cachedFunction()", " at cached.cpp:10");
+    test(lookup(addr), "cachedFunction() at cached.cpp:10");
+    symcache::reset();
+    test(lookup(addr), "{not found}");
+
+    // Flushed entries are read from the file
+    symcache::store(addr, "cachedFunction()", " at cached.cpp:10");
+    symcache::flush();
+    test(std::to_string(access(fileName.c_str(), R_OK) == 0), "1");
+    symcache::reset();
+    test(lookup(addr), "cachedFunction() at cached.cpp:10");
+    test(lookup(other), "{not found}");
+
+    // New entries are merged with the loaded ones
+    symcache::store(other, "otherFunction()", "");
+    symcache::store(addr, "cachedFunction()", " at cached.cpp:11");
+    symcache::flush();
+    symcache::reset();
+    test(lookup(other), "otherFunction()");
+    test(lookup(addr), "cachedFunction() at cached.cpp:11");
+    test(lookup(nullptr), "{not found}");
+
+    // Resolver asks the cache before symbolizer and addr2line
+    resolve::settings::btPersistentCache = true;
+    test(resolveAddr2Name(other), "otherFunction()");
+    test(resolveAddr2Name(addr, true), "cachedFunction() at cached.cpp:11");
+    // .. and keeps answers of symbolizer
+    auto* symbolized = reinterpret_cast<const void*>(&symbolizedFunction);
+    test(resolveAddr2Name(symbolized), "tsv::debuglog::tests::test_symcache::symbolizedFunction()");
+    test(lookup(symbolized), "tsv::debuglog::tests::test_symcache::symbolizedFunction()");
+    resolve::settings::btPersistentCache = false;
+
+    // Entries written by other process after the file was mapped are kept
+    std::string savedName = fileName + ".saved";
+    std::rename(fileName.c_str(), savedName.c_str());
+    symcache::reset();
+    symcache::store(other, "otherFunction(int)", "");
+    std::rename(savedName.c_str(), fileName.c_str());
+    symcache::flush();
+    symcache::reset();
+    test(lookup(other), "otherFunction(int)");
+    test(lookup(addr), "cachedFunction() at cached.cpp:11");
+
+    // Periodical flush doesn't write too often
+    symcache::store(other, "otherFunction()", "");
+    symcache::flushPeriodically();
+    symcache::reset();
+    test(lookup(other), "otherFunction(int)");
+
+    // Broken file is ignored
+    FILE* file = std::fopen(fileName.c_str(), "wb");
+    if (file)
+    {
+        std::fputs("garbage", file);
+        std::fclose(file);
+    }
+    symcache::reset();
+    test(lookup(addr), "{not found}");
+
+    std::remove(fileName.c_str());
+    std::remove((resolve::settings::btCacheDir + "/.lock").c_str());
+    rmdir(resolve::settings::btCacheDir.c_str());
+    if (dir)
+        rmdir(dir);
+    symcache::reset();
+    resolve::settings::btCacheDir.clear();
+    setupDefault("tsv::debuglog::tests::");
+}
+
+}  // namespace tsv::debuglog::tests::test_symcache
@@ -0,0 +1,81 @@
+/**
+ * Tests tail buffering of the scope (SentryLogger::Flags::TailBuffer)
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up handler and other settings
+#include "debuglog_settings.h"
+
+#include "main.h"
+#include <chrono>
+#include <thread>
+
+namespace tsv::debuglog::tests::test_tail
+{
+
+void testChild(int x)
+{
+    SENTRY_FUNC()(x);
+    if (x < 0)
+        SAY_DBG_L(SentryLogger::Level::Error, "negative");
+    SAY_FMT_DEFERRED("deferred {}", x);
+}
+
+void testRequest(int x, std::uint64_t thresholdUs = 0, int sleepMs = 0)
+{
+    SENTRY_FUNC({SentryLogger::Kind::Default,
+                 SentryLogger::Level::Default,
+                 SentryLogger::Flags::TailBuffer,
+                 /*.enabled=*/true,
+                 /*.object=*/nullptr,
+                 thresholdUs})(x);
+    SAY_DBG("start");
+    testChild(x);
+    if (sleepMs)
+        std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+
+    // Fast and successful - nothing is printed
+    testRequest(1);
+    TEST("");
+
+    // Error inside of the child scope - whole scope is printed at the end
+    testRequest(-1);
+    TEST(
+        "[Info:Dflt]01>{test_tail::testRequest}>> Enter x = -1\n"
+        "[Info:Dflt]01 {test_tail::testRequest}start\n"
+        "[Info:Dflt]02>>{test_tail::testChild}>> Enter x = -1\n"
+        "[Err:Dflt]02  {test_tail::testChild}negative\n"
+        "[Err:Dflt]02  {test_tail::testChild}deferred -1\n"
+        "[Err:Dflt]02<<{test_tail::testChild}>> Leave scope\n"
+        "[Info:Dflt]01<{test_tail::testRequest}>> Leave scope\n"
+        );
+
+    // Slow scope
+    testRequest(2, 1000, 5);
+    TEST(
+        "[Info:Dflt]01>{test_tail::testRequest}>> Enter x = 2\n"
+        "[Info:Dflt]01 {test_tail::testRequest}start\n"
+        "[Info:Dflt]02>>{test_tail::testChild}>> Enter x = 2\n"
+        "[Info:Dflt]02  {test_tail::testChild}deferred 2\n"
+        "[Info:Dflt]02<<{test_tail::testChild}>> Leave scope\n"
+        "[Info:Dflt]01<{test_tail::testRequest}>> Leave scope\n"
+        );
+    testRequest(3, 1000000);
+    TEST("");
+
+    // Lines outside of the scope are not buffered
+    testChild(4);
+    TEST(
+        "[Info:Dflt]01>{test_tail::testChild}>> Enter x = 4\n"
+        "[Info:Dflt]01 {test_tail::testChild}deferred 4\n"
+        "[Info:Dflt]01<{test_tail::testChild}>> Leave scope\n"
+        );
+}
+
+}  // namespace tsv::debuglog::tests::test_tail
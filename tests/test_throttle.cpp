@@ -0,0 +1,157 @@
+/**
+ * Tests per-call-site throttling
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up handler and other settings
+#include "debuglog_settings.h"
+
+#include "main.h"
+#include <algorithm>
+#include <thread>
+
+namespace tsv::debuglog::tests::test_throttle
+{
+
+int evaluated = 0;
+
+int touch(int x)
+{
+    evaluated++;
+    return x;
+}
+
+void testEveryN()
+{
+    SENTRY_FUNC();
+    for (int i = 0; i < 7; i++)
+        SAY_ARGS_THROTTLED(everyN(3), touch(i));
+}
+
+void testFirstN()
+{
+    SENTRY_CONTEXT("first");
+    for (int i = 0; i < 5; i++)
+        SAY_FMT_THROTTLED(firstN(2), "i={}", touch(i));
+}
+
+void testPerSecond()
+{
+    SENTRY_CONTEXT("rate");
+    // Burst is limited by the rate, so only 3 of them pass
+    for (int i = 0; i < 10; i++)
+        SAY_DBG_THROTTLED(perSecond(3), "burst");
+}
+
+void testNested()
+{
+    SENTRY_FUNC();
+    SAY_DBG("nested");
+}
+
+void testScope(int x)
+{
+    SENTRY_FUNC_THROTTLED(firstN(1))(x);
+    SAY_DBG("inside");
+    testNested();
+}
+
+// Throttle works even if the scope prints no borders itself
+void testSilentScope()
+{
+    SENTRY_FUNC_THROTTLED(firstN(1), {/*.kind=*/SentryLogger::Kind::Default,
+                                      /*.level=*/SentryLogger::Level::Default,
+                                      /*.flags=*/SentryLogger::Flags::SuppressBorders});
+    SAY_DBG("silent");
+    testNested();
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+
+    testEveryN();
+    TEST(
+        "[Info:Dflt]01>{test_throttle::testEveryN}>> Enter scope\n"
+        "[Info:Dflt]01 {test_throttle::testEveryN}touch(i) = 0\n"
+        "[Info:Dflt]01 {test_throttle::testEveryN}[debuglog] 2 messages suppressed\n"
+        "[Info:Dflt]01 {test_throttle::testEveryN}touch(i) = 3\n"
+        "[Info:Dflt]01 {test_throttle::testEveryN}[debuglog] 2 messages suppressed\n"
+        "[Info:Dflt]01 {test_throttle::testEveryN}touch(i) = 6\n"
+        "[Info:Dflt]01<{test_throttle::testEveryN}>> Leave scope\n"
+        );
+    // Arguments of suppressed calls are not evaluated
+    test(std::to_string(evaluated), "3");
+
+    evaluated = 0;
+    testFirstN();
+    TEST(
+        "[Info:Dflt]01>{first}>> Enter scope\n"
+        "[Info:Dflt]01 {first}i=0\n"
+        "[Info:Dflt]01 {first}i=1\n"
+        "[Info:Dflt]01<{first}>> Leave scope\n"
+        );
+    test(std::to_string(evaluated), "2");
+
+    testPerSecond();
+    TEST(
+        "[Info:Dflt]01>{rate}>> Enter scope\n"
+        "[Info:Dflt]01 {rate}burst\n"
+        "[Info:Dflt]01 {rate}burst\n"
+        "[Info:Dflt]01 {rate}burst\n"
+        "[Info:Dflt]01<{rate}>> Leave scope\n"
+        );
+
+    // Disabled by kind - throttle is not even touched
+    {
+        Settings::TemporarySettings tmp({{SentryLogger::Kind::Default, false}});
+        testFirstN();
+    }
+    TEST("");
+
+    // Throttle state is shared by all threads
+    std::thread worker([] {
+        testScope(1);
+        testScope(2);
+    });
+    worker.join();
+    testScope(3);
+    TEST(
+        "[Info:Dflt]01>{test_throttle::testScope}>> Enter x = 1\n"
+        "[Info:Dflt]01 {test_throttle::testScope}inside\n"
+        "[Info:Dflt]02>>{test_throttle::testNested}>> Enter scope\n"
+        "[Info:Dflt]02  {test_throttle::testNested}nested\n"
+        "[Info:Dflt]02<<{test_throttle::testNested}>> Leave scope\n"
+        "[Info:Dflt]01<{test_throttle::testScope}>> Leave scope\n"
+        );
+    // Suppression ends with the scope
+    testNested();
+    TEST(
+        "[Info:Dflt]01>{test_throttle::testNested}>> Enter scope\n"
+        "[Info:Dflt]01 {test_throttle::testNested}nested\n"
+        "[Info:Dflt]01<{test_throttle::testNested}>> Leave scope\n"
+        );
+
+    testSilentScope();
+    testSilentScope();
+    TEST(
+        "[Info:Dflt]01 {test_throttle::testSilentScope}silent\n"
+        "[Info:Dflt]02>>{test_throttle::testNested}>> Enter scope\n"
+        "[Info:Dflt]02  {test_throttle::testNested}nested\n"
+        "[Info:Dflt]02<<{test_throttle::testNested}>> Leave scope\n"
+        );
+
+    // Sites which never pass anything more are reported on demand
+    throttle::dumpSuppressed();
+    TEST(
+        "[Warn:Dflt]00 {throttle}[debuglog] 1 messages suppressed at test_throttle.cpp:63\n"
+        "[Warn:Dflt]00 {throttle}[debuglog] 2 messages suppressed at test_throttle.cpp:55\n"
+        "[Warn:Dflt]00 {throttle}[debuglog] 7 messages suppressed at test_throttle.cpp:44\n"
+        "[Warn:Dflt]00 {throttle}[debuglog] 3 messages suppressed at test_throttle.cpp:36\n"
+        );
+    throttle::dumpSuppressed();
+    TEST("");
+}
+
+}  // namespace tsv::debuglog::tests::test_throttle
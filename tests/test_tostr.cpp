@@ -18,6 +18,7 @@
 #include <memory>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace tsv::debuglog::tests
 {
@@ -50,6 +51,14 @@ enum class TestEnum : unsigned
    V2
 };
 
+// Not contiguous values
+enum SparseEnum : int
+{
+   SparseNegative = -5,
+   SparseZero = 0,
+   SparseBig = 100
+};
+
 std::string knownPtrLog = "";
 void MyKnownPtrLogger(const std::string& log_str )
 {
@@ -92,13 +101,25 @@ bool test_tostr()
     test( toStr(vv), "str");
     test( toStr(ss), "std_str");
     test( toStr(ss, ENUM_TOSTR_REPR), "\"std_str\"");
-#if defined(DEBUGLOG_USEMAGIC_ENUM) || defined(DEBUGLOG_USEREFLECT_ENUM)
+#if DEBUGLOG_USEMAGIC_ENUM || DEBUGLOG_USEREFLECT_ENUM
     test( toStr(e), "tsv::debuglog::tests::TestEnum::V2(4)");
+    test( TOSTR_JOIN(SparseNegative, ",", SparseBig, ",", static_cast<SparseEnum>(7)),
+          "tsv::debuglog::tests::SparseEnum::SparseNegative(-5),tsv::debuglog::tests::SparseEnum::SparseBig(100),"
+          "tsv::debuglog::tests::SparseEnum::(7)");
+    settings::showEnumInteger = false;
+    test( TOSTR_JOIN(e, ",", SparseZero), "tsv::debuglog::tests::TestEnum::V2,tsv::debuglog::tests::SparseEnum::SparseZero");
+    settings::showEnumInteger = true;
 #else
     test( toStr(e), "tsv::debuglog::tests::TestEnum::4");
+    test( TOSTR_JOIN(SparseNegative, ",", SparseBig), "tsv::debuglog::tests::SparseEnum::-5,tsv::debuglog::tests::SparseEnum::100");
 #endif
 
     std::cout << "\nPOINTERS:\n";
+    // Type names are computed once
+    test( std::string( getTypeName<std::vector<int>>() ), "std::vector<int, std::allocator<int> >" );
+    test( std::to_string( &getTypeName<int>() == &getTypeName<int>() ), "1" );
+    test( std::to_string( &tsv::debuglog::demangle(typeid(float).name()) == &tsv::debuglog::demangle("f") ), "1" );
+
     std::string vv_addr( hex_addr(vv) );
     test( hex_addr(vv), "0xADDR", true );
     test( toStr(&vv), "0xADDR", true );          // Do not show content for pointer to pointer
@@ -108,7 +129,7 @@ bool test_tostr()
     test( toStr(&ss), "0xADDR (std_str)", true );   // Pointer to known type shows its content
     test( toStr(&x), "0xADDR (-10)", true );         // (for POD types too)
     test( toStr(&c), "0xADDR (tsv::debuglog::tests::TempClass)", true );   // for unknown type - say its typename
-#if defined(DEBUGLOG_USEMAGIC_ENUM) || defined(DEBUGLOG_USEREFLECT_ENUM)
+#if DEBUGLOG_USEMAGIC_ENUM || DEBUGLOG_USEREFLECT_ENUM
     test( toStr(&e), "0xADDR (tsv::debuglog::tests::TestEnum::V2(4))", true);
 #else
     test( toStr(&e), "0xADDR (tsv::debuglog::tests::TestEnum::4)", true);
@@ -220,6 +241,17 @@ bool test_tostr()
     test(join(myMap, "|", ENUM_TOSTR_EXTENDED),
          "{\"first\": ExtAppearance#44/55}|{\"second\": ExtAppearance#71/72}");
 
+    // Everything is appended to the one buffer
+    std::string buffer = "buf:";
+    appendTo(buffer, -10, ENUM_TOSTR_REPR_HEX);
+    appendTo(buffer, 0.25);
+    appendTo(buffer, std::make_pair(1, "one"));
+    appendTo(buffer, AppendedClass{5});
+    appendJoin(buffer, mySet, "|");
+    test(std::move(buffer), "buf:-0xa0.250000{1: \"one\"}Appended#5BaseAppearance#44|BaseAppearance#71");
+    test(TOSTR_ARGS(AppendedClass{7}, Details::NormalHex, AppendedClass{255}),
+         "AppendedClass{7} = Appended#7, AppendedClass{255} = Appended#0xff");
+
     std::cout << "\n\nMACRO:\n";
 
     test( TOSTR_ARGS( "ARGS:", x, f, "; More tests:", vv, add(x,17), y ),
@@ -251,6 +283,15 @@ bool test_tostr()
     // Nested TOSTR_* macro added as is, so could be used in SENTRY_* macro to replace content
     test( TOSTR_ARGS( "NESTED: ", TOSTR_JOIN("join_",1), "; ", TOSTR_FMT("fmt_{}",2)), //
                 "NESTED: join_1; fmt_2" );
+    test( TOSTR_ARGS( "NESTED ARGS:", TOSTR_ARGS(x), TOSTR_EXPR(x, "+", 1), y ), //
+                "NESTED ARGS:x = -10x{-10} + 1 , y = 15" );
+
+    // Names are classified at compile time
+    static_assert( classifyArg("\"literal\"").flags == (ArgName::AsIs | ArgName::Quoted) );
+    static_assert( classifyArg("'c'").flags == ArgName::AsIs );
+    static_assert( classifyArg("42").flags == ArgName::AsIs );
+    static_assert( classifyArg(MACRO_TOSTR__STRINGIZE(TOSTR_ARGS(x))).flags == ArgName::AsIs );
+    static_assert( classifyArg("x").flags == ArgName::Variable );
 
      // test empty macro
     test( TOSTR_ARGS() + TOSTR_JOIN() + TOSTR_EXPR(), "");
@@ -18,4 +18,10 @@ struct KnownClass
      }
 };
 
+// Sample class with the handler which appends directly to the output
+struct AppendedClass
+{
+     int x;
+};
+
 }
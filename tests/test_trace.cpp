@@ -0,0 +1,91 @@
+/**
+ * Tests export of sentries to Chrome Trace Event Format
+ */
+
+#include "debuglog.h"
+
+// In most files this include doesn't needed, but here we set up handler and other settings
+#include "debuglog_settings.h"
+#include "debuglog_trace.h"
+
+#include "main.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+namespace tsv::debuglog::tests::test_trace
+{
+
+int testInner(int x)
+{
+    SENTRY_FUNC()(x);
+    SAY_ARGS("inner", x);
+    SAY_AND_RETURN(x * 2);
+}
+
+void testOuter(const std::string& s)
+{
+    SENTRY_FUNC()(s);
+    testInner(5);
+    SAY_FMT_DEFERRED("deferred \"{}\"", s);
+}
+
+// Read the trace and replace values which differ from run to run
+std::string readTrace(const std::string& path)
+{
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    std::remove(path.c_str());
+    static const std::regex variable("\"(ts|dur|pid|tid)\":[0-9.]+");
+    return std::regex_replace(ss.str(), variable, "\"$1\":N");
+}
+
+void run()
+{
+    setupDefault("tsv::debuglog::tests::");
+
+    std::string path = "test_trace.json";
+    test(std::to_string(trace::start(path)), "1");
+    test(std::to_string(trace::start(path)), "0");
+    testOuter("str");
+    trace::stop();
+    loggedString.clear();
+
+    test(readTrace(path),
+         "{\"traceEvents\":[\n"
+         "{\"name\":\"inner x = 5\",\"cat\":\"say\",\"ph\":\"i\",\"s\":\"t\",\"ts\":N,\"pid\":N,\"tid\":N,"
+         "\"args\":{\"context\":\"test_trace::testInner\"}},\n"
+         "{\"name\":\"test_trace::testInner\",\"cat\":\"sentry\",\"ph\":\"X\",\"ts\":N,\"dur\":N,\"pid\":N,\"tid\":N,"
+         "\"args\":{\"enter\":\"x = 5\",\"rv\":\"10\"}},\n"
+         "{\"name\":\"deferred \\\"str\\\"\",\"cat\":\"say\",\"ph\":\"i\",\"s\":\"t\",\"ts\":N,\"pid\":N,\"tid\":N,"
+         "\"args\":{\"context\":\"test_trace::testOuter\"}},\n"
+         "{\"name\":\"test_trace::testOuter\",\"cat\":\"sentry\",\"ph\":\"X\",\"ts\":N,\"dur\":N,\"pid\":N,\"tid\":N,"
+         "\"args\":{\"enter\":\"s = \\\"str\\\"\"}},\n"
+         "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":N,\"args\":{\"name\":\"debuglog\"}}\n"
+         "],\"displayTimeUnit\":\"ns\"}\n");
+
+    // Tiny chunks: each event is written immediately. Events of the finished thread are kept.
+    test(std::to_string(trace::start(path, {/*.chunkSize=*/1})), "1");
+    std::thread worker([] {
+        for (int i = 0; i < 10; i++)
+            testInner(i);
+    });
+    worker.join();
+    testInner(1);
+    trace::stop();
+    loggedString.clear();
+
+    auto content = readTrace(path);
+    test(std::to_string(std::count(content.begin(), content.end(), '\n')), "25");
+
+    // Not active - nothing is collected
+    testInner(2);
+    loggedString.clear();
+    test(std::to_string(std::ifstream(path).good()), "0");
+}
+
+}  // namespace tsv::debuglog::tests::test_trace